@@ -243,6 +243,7 @@ void ConfigManager::SetDefaults() {
     config["profileName"] = "";      
     config["profilePath"] = "";      
     config["queryDelay"] = "100";    
+    config["scanLaunchIntervalUs"] = std::to_string(SCAN_LAUNCH_INTERVAL_US);
 
     OutputDebugStringA("Set all default config values\n");
 }
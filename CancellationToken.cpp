@@ -0,0 +1,125 @@
+#include "CancellationToken.h"
+#include <algorithm>
+
+
+static thread_local CancellationToken* currentCancellation = nullptr;
+
+
+CancellationToken::CancellationToken() {
+    cancelEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+}
+
+CancellationToken::~CancellationToken() {
+    if (cancelEvent) {
+        CloseHandle(cancelEvent);
+    }
+}
+
+void CancellationToken::Cancel() {
+    std::vector<std::pair<size_t, std::function<void()>>> running;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        if (cancelled.exchange(true)) return;
+
+        running.swap(callbacks);
+        dispatching = true;
+        dispatchThread = std::this_thread::get_id();
+    }
+
+    if (cancelEvent) {
+        SetEvent(cancelEvent);
+    }
+    for (auto& callback : running) {
+        callback.second();
+        {
+            std::lock_guard<std::mutex> lock(callbackMutex);
+            finishedId = callback.first;
+        }
+        callbackFinished.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        dispatching = false;
+        dispatchThread = std::thread::id();
+    }
+    callbackFinished.notify_all();
+}
+
+bool CancellationToken::Wait(DWORD milliseconds) const {
+    if (IsCancelled()) return true;
+    if (!cancelEvent) {
+        Sleep(milliseconds);
+        return IsCancelled();
+    }
+    return WaitForSingleObject(cancelEvent, milliseconds) == WAIT_OBJECT_0;
+}
+
+size_t CancellationToken::Register(std::function<void()> callback) {
+    std::unique_lock<std::mutex> lock(callbackMutex);
+    if (cancelled.load()) {
+        lock.unlock();
+        callback();
+        return 0;
+    }
+
+    size_t id = nextId++;
+    callbacks.emplace_back(id, std::move(callback));
+    return id;
+}
+
+bool CancellationToken::Unregister(size_t id) {
+    std::unique_lock<std::mutex> lock(callbackMutex);
+    auto it = std::find_if(callbacks.begin(), callbacks.end(),
+        [id](const std::pair<size_t, std::function<void()>>& callback) { return callback.first == id; });
+    if (it != callbacks.end()) {
+        callbacks.erase(it);
+        return true;
+    }
+
+    if (dispatchThread != std::this_thread::get_id()) {
+        callbackFinished.wait(lock, [this, id]() { return !dispatching || finishedId >= id; });
+    }
+    return false;
+}
+
+CancellationToken* CancellationToken::Current() {
+    return currentCancellation;
+}
+
+bool CancellationToken::WaitCurrent(DWORD milliseconds) {
+    if (currentCancellation) {
+        return currentCancellation->Wait(milliseconds);
+    }
+    Sleep(milliseconds);
+    return false;
+}
+
+
+CancellationToken::Scope::Scope(CancellationToken* token) : previous(currentCancellation) {
+    currentCancellation = token;
+}
+
+CancellationToken::Scope::~Scope() {
+    currentCancellation = previous;
+}
+
+
+CancellationToken::Registration::Registration(CancellationToken* token, std::function<void()> callback)
+    : token(token), id(0) {
+    if (token) {
+        id = token->Register(std::move(callback));
+        if (id == 0) {
+            released = true;
+            pending = false;
+        }
+    }
+}
+
+bool CancellationToken::Registration::Release() {
+    if (!released) {
+        released = true;
+        pending = !token || token->Unregister(id);
+    }
+    return pending;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Platform.h"
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <cstddef>
+
+
+class CancellationToken {
+public:
+    CancellationToken();
+    ~CancellationToken();
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void Cancel();
+    bool IsCancelled() const { return cancelled.load(); }
+    bool Wait(DWORD milliseconds) const;
+
+    size_t Register(std::function<void()> callback);
+    bool Unregister(size_t id);
+
+    static CancellationToken* Current();
+    static bool WaitCurrent(DWORD milliseconds);
+
+    class Scope {
+    public:
+        explicit Scope(CancellationToken* token);
+        ~Scope();
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        CancellationToken* previous;
+    };
+
+    class Registration {
+    public:
+        Registration(CancellationToken* token, std::function<void()> callback);
+        ~Registration() { Release(); }
+
+        bool Release();
+
+    private:
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+        CancellationToken* token;
+        size_t id;
+        bool released = false;
+        bool pending = true;
+    };
+
+private:
+    std::atomic<bool> cancelled{ false };
+    HANDLE cancelEvent;
+    std::mutex callbackMutex;
+    std::condition_variable callbackFinished;
+    std::vector<std::pair<size_t, std::function<void()>>> callbacks;
+    size_t nextId = 1;
+    bool dispatching = false;
+    size_t finishedId = 0;
+    std::thread::id dispatchThread;
+};
+
+typedef std::shared_ptr<CancellationToken> CancellationTokenRef;
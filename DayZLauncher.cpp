@@ -12,6 +12,8 @@ using std::min;
 #include <iostream>
 #include <sstream>
 #include <regex>
+#include <cstdarg>
+#include <cstdio>
 
 #ifdef min
 #undef min
@@ -24,10 +26,27 @@ using std::min;
 extern std::unique_ptr<DayZLauncher> g_launcher;
 
 
+static void DebugLogFormat(const char* format, ...) {
+    char message[512];
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(message, sizeof(message) - 1, format, args);
+    va_end(args);
+
+    if (written < 0) written = 0;
+    if (written > static_cast<int>(sizeof(message)) - 2) written = static_cast<int>(sizeof(message)) - 2;
+    message[written] = '\n';
+    message[written + 1] = '\0';
+    OutputDebugStringA(message);
+}
+
+
 DayZLauncher::DayZLauncher() : hWnd(nullptr), hTab(nullptr), hServerList(nullptr),
 hRefreshBtn(nullptr), hJoinBtn(nullptr), hFavoriteBtn(nullptr),
 hFilterEdit(nullptr), hStatusBar(nullptr), hProgressBar(nullptr),
-currentTab(0), shouldStopRefresh(false), currentSortColumn(SORT_PING),
+hMinPlayersEdit(nullptr), hMaxPingEdit(nullptr),
+currentTab(0), currentSortColumn(SORT_PING),
 sortAscending(true), originalListViewProc(nullptr) {
 
     InitializeManagers();
@@ -47,16 +66,22 @@ void DayZLauncher::InitializeManagers() {
     favoritesManager = std::make_unique<FavoritesManager>();
     configManager = std::make_unique<ConfigManager>();
     serverCache = std::make_unique<ServerCache>();
-    threadPool = std::make_unique<ThreadPool>(4);
+    threadPool = std::make_unique<ThreadPool>();
+    queryEngine = std::make_unique<QueryEngine>();
+    filterWorker.SetThreadPool(threadPool.get());
 }
 
 void DayZLauncher::CleanupManagers() {
+    filterWorker.Stop();
+
     if (refreshThread.joinable()) {
-        shouldStopRefresh = true;
+        scanCancel->Cancel();
         refreshThread.join();
     }
 
+    queryEngine->Stop();
     threadPool.reset();
+    queryEngine.reset();
     serverCache.reset();
     trayManager.reset();
     configManager.reset();
@@ -79,6 +104,11 @@ bool DayZLauncher::Initialize(HINSTANCE hInstance) {
         return false;
     }
 
+    if (!queryEngine->Start((std::max)(1, configManager->GetInt("maxQueriesInFlight", QUERYENGINE_MAX_IN_FLIGHT)))) {
+        MessageBox(hWnd, L"Failed to start the server query engine", L"Error", MB_OK | MB_ICONERROR);
+        return false;
+    }
+
 
     trayManager = std::make_unique<SystemTrayManager>(hWnd);
     ApplyModernStyling();
@@ -770,28 +800,29 @@ void DayZLauncher::ApplyModernStyling() {
 }
 
 void DayZLauncher::RefreshServers() {
-    if (isRefreshing.load()) return;
+    if (refreshThread.joinable()) {
+        auto cancelStart = std::chrono::steady_clock::now();
+        scanCancel->Cancel();
+        refreshThread.join();
+        DebugLogFormat("Previous scan stopped in %d ms", static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - cancelStart).count()));
+    }
 
     isRefreshing = true;
     UpdateStatusBar("Refreshing servers...");
     UpdateProgressBar(0);
 
- 
-    if (refreshThread.joinable()) {
-        shouldStopRefresh = true;
-        refreshThread.join();
-    }
-
-    shouldStopRefresh = false;
+    scanCancel = std::make_shared<CancellationToken>();
+    SetTimer(hWnd, IDT_SCAN_DRAIN, SCAN_DRAIN_INTERVAL_MS, NULL);
 
 
-    HANDLE hThread = CreateThread(NULL, 0, RefreshServersThread, this, 0, NULL);
-    if (hThread) {
-        CloseHandle(hThread);
+    try {
+        refreshThread = std::thread(RefreshServersThread, this);
         OutputDebugStringA("RefreshServersThread created successfully!\n");
     }
-    else {
+    catch (...) {
         OutputDebugStringA("ERROR: Failed to create RefreshServersThread!\n");
+        KillTimer(hWnd, IDT_SCAN_DRAIN);
         isRefreshing = false;
         UpdateStatusBar("ERROR: Failed to start refresh thread!");
     }
@@ -802,15 +833,22 @@ DWORD CALLBACK DayZLauncher::RefreshServersThread(LPVOID lpParam) {
 
     OutputDebugStringA("=== REFRESH THREAD STARTED ===\n");
 
+    ScanArena scanArena;
+    ScanArena::Scope arenaScope(scanArena);
+
+    CancellationTokenRef cancel = launcher->scanCancel;
+    CancellationToken::Scope cancelScope(cancel.get());
+    CancellationToken::Registration wakeQueries(cancel.get(), [launcher]() { launcher->queryManager->Interrupt(); });
+
  
     {
         std::lock_guard<std::mutex> lock(launcher->serverMutex);
-        launcher->servers.clear();
+        launcher->servers.Clear();
     }
 
 
-    PostMessage(launcher->hWnd, WM_USER + 200, 0, (LPARAM)"Querying Steam master servers...");
-    PostMessage(launcher->hWnd, WM_UPDATE_PROGRESS, 10, 0);
+    launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, "Querying Steam master servers...");
+    launcher->PostScanEvent(SCAN_EVENT_PROGRESS, 10);
 
    
     std::vector<std::pair<std::string, int>> serverAddresses;
@@ -820,13 +858,13 @@ DWORD CALLBACK DayZLauncher::RefreshServersThread(LPVOID lpParam) {
     if (launcher->queryManager->QuerySteamMasterServer(serverAddresses)) {
         foundServers = true;
         OutputDebugStringA(("Found " + std::to_string(serverAddresses.size()) + " servers from Steam master\n").c_str());
-        PostMessage(launcher->hWnd, WM_USER + 200, 0, (LPARAM)("Found " + std::to_string(serverAddresses.size()) + " servers from Steam master").c_str());
+        launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, "Found " + std::to_string(serverAddresses.size()) + " servers from Steam master");
     }
 
  
-    if (!foundServers) {
+    if (!foundServers && !cancel->IsCancelled()) {
         OutputDebugStringA("Trying direct master server...\n");
-        PostMessage(launcher->hWnd, WM_USER + 200, 0, (LPARAM)"Trying direct master server...");
+        launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, "Trying direct master server...");
         if (launcher->queryManager->QuerySteamMasterServerDirect(serverAddresses)) {
             foundServers = true;
             OutputDebugStringA(("Found " + std::to_string(serverAddresses.size()) + " servers from direct query\n").c_str());
@@ -834,9 +872,14 @@ DWORD CALLBACK DayZLauncher::RefreshServersThread(LPVOID lpParam) {
     }
 
 
+    if (cancel->IsCancelled()) {
+        OutputDebugStringA("=== REFRESH THREAD CANCELLED ===\n");
+        return 0;
+    }
+
     if (!foundServers || serverAddresses.empty()) {
         OutputDebugStringA("Using fallback server list...\n");
-        PostMessage(launcher->hWnd, WM_USER + 200, 0, (LPARAM)"Master servers failed, using backup list...");
+        launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, "Master servers failed, using backup list...");
 
         serverAddresses.clear();
         serverAddresses.push_back(std::make_pair(std::string("172.236.0.90"), 4167));   
@@ -847,144 +890,198 @@ DWORD CALLBACK DayZLauncher::RefreshServersThread(LPVOID lpParam) {
         serverAddresses.push_back(std::make_pair(std::string("139.99.144.41"), 2302));   
     }
 
-    PostMessage(launcher->hWnd, WM_UPDATE_PROGRESS, 20, 0);
-
-    int totalServers = static_cast<int>(serverAddresses.size());
-    int processedServers = 0;
-    int successfulQueries = 0;
-
-    std::string statusMsg = "Querying " + std::to_string(totalServers) + " servers for details...";
-    PostMessage(launcher->hWnd, WM_USER + 200, 0, (LPARAM)statusMsg.c_str());
-    OutputDebugStringA((statusMsg + "\n").c_str());
-
-    for (size_t i = 0; i < serverAddresses.size() && !launcher->shouldStopRefresh; ++i) {
-        const std::pair<std::string, int>& addr = serverAddresses[i];
-
-        OutputDebugStringA(("Querying server: " + addr.first + ":" + std::to_string(addr.second) + "\n").c_str());
-
-        ServerInfo info;
-        A2SInfoResponse response;
+    launcher->PostScanEvent(SCAN_EVENT_PROGRESS, 20);
 
+    {
+        std::lock_guard<std::mutex> lock(launcher->serverMutex);
+        launcher->servers.Reserve(serverAddresses.size());
+    }
 
-        bool serverResponded = false;
-        int retries = 2;
+    typedef std::pair<std::string, int> ServerAddress;
 
-        for (int attempt = 0; attempt < retries && !serverResponded; ++attempt) {
-            if (launcher->queryManager->QueryServerInfo(addr.first, addr.second, response)) {
-                serverResponded = true;
-                break;
-            }
-            if (attempt < retries - 1) {
-                Sleep(500); 
+    int totalServers = static_cast<int>(serverAddresses.size());
+    int launchIntervalUs = (std::max)(0, launcher->configManager->GetInt("scanLaunchIntervalUs", SCAN_LAUNCH_INTERVAL_US));
+    int enrichWorkers = (std::max)(1, launcher->configManager->GetInt("scanEnrichWorkers", SCAN_ENRICH_WORKERS));
+    int rulesWorkers = (std::max)(1, launcher->configManager->GetInt("scanRulesWorkers", SCAN_RULES_WORKERS));
+    std::atomic<int> addedServers{ 0 };
+    std::atomic<int> moddedServers{ 0 };
+
+    size_t flowLimit = launcher->queryEngine->GetMaxInFlight();
+    ScanQueryWindow window(static_cast<ptrdiff_t>(flowLimit));
+    std::chrono::microseconds launchSpacing(launchIntervalUs);
+
+    QueryFlightsRef rulesFlights = std::make_shared<QueryFlights>();
+    PipelineStage<ServerAddress, ScanQueryContext> rulesStage("rules");
+    PipelineStage<ServerInfo> enrichStage("enrich", flowLimit);
+
+    CancellationToken::Registration abortStages(cancel.get(), [&]() {
+        launcher->queryEngine->Wake();
+        enrichStage.Abort();
+        rulesStage.Abort();
+    });
+
+    bool started = rulesStage.Start(rulesWorkers, cancel.get(),
+        [launcher, &moddedServers](ServerAddress& addr, ScanQueryContext& context) {
+            A2SRulesResponse rules;
+            ModSetRef mods;
+            if (!context.ready || !context.query.QueryServerRules(addr.first, addr.second, rules)) return;
+            if (!launcher->ExtractModsFromRules(rules, mods)) return;
+
+            std::lock_guard<std::mutex> lock(launcher->serverMutex);
+            ServerId id = launcher->servers.FindId(addr.first, addr.second);
+            ServerInfo* server = launcher->servers.Get(id);
+            if (server) {
+                server->mods = mods;
+                launcher->servers.Update(id);
+                moddedServers++;
             }
-        }
-
-        if (serverResponded) {
-            OutputDebugStringA(("Server responded: " + response.name + "\n").c_str());
-
-        
-            std::string cleanName = response.name;
+        },
+        [&rulesFlights](ScanQueryContext& context) { context.query.ShareFlights(rulesFlights); });
 
-         
-            cleanName.erase(std::remove(cleanName.begin(), cleanName.end(), '\0'), cleanName.end());
+    started = started && enrichStage.Start(enrichWorkers, cancel.get(),
+        [launcher, &rulesStage, &addedServers, &window](ServerInfo& info, NoStageContext&) {
+            info.isOfficial = launcher->DetectOfficialServer(info.name, info.folder);
+            info.isFavorite = launcher->favoritesManager->IsFavorite(info.ip, info.port);
+            info.isPlayed = launcher->favoritesManager->HasPlayed(info.ip, info.port);
+            info.lastUpdated = time(nullptr);
+            info.setDetails(InternedString(), launcher->GetCountryFromIP(info.ip));
 
-   
-            for (char& c : cleanName) {
-                if (c < 32 || c > 126) {
-                    c = ' ';
-                }
+            ServerAddress addr(info.ip, info.port);
+            {
+                std::lock_guard<std::mutex> lock(launcher->serverMutex);
+                launcher->servers.Upsert(std::move(info));
             }
 
-    
-            cleanName.erase(0, cleanName.find_first_not_of(" \t\r\n"));
-            cleanName.erase(cleanName.find_last_not_of(" \t\r\n") + 1);
+            addedServers++;
+            DebugLogFormat("Successfully added server: %s:%d", addr.first.c_str(), addr.second);
 
-       
-            if (cleanName.empty() || cleanName.length() > 200 ||
-                response.maxPlayers > 200 || response.maxPlayers < 1) {
-                OutputDebugStringA("Skipping server with invalid data\n");
-                continue;
-            }
+            window.slots.release();
 
- 
-            info.name = cleanName;
-            info.map = response.map.empty() ? "Unknown" : response.map;
-            info.ip = addr.first;
-            info.port = addr.second;
-            info.players = response.players;
-            info.maxPlayers = response.maxPlayers;
-            info.version = response.version.empty() ? "1.27" : response.version;
-            info.hasVAC = (response.vac == 1);
-            info.isPassworded = (response.visibility == 1);
-            info.folder = response.folder;
+            if (!rulesStage.Input().TryPush(addr)) {
+                DebugLogFormat("Rules queue full, skipping mod lookup for %s:%d", addr.first.c_str(), addr.second);
+            }
+        });
 
-       
-            info.isOfficial = launcher->DetectOfficialServer(info.name, info.folder);
+    if (!started) {
+        OutputDebugStringA("ERROR: Failed to start scan pipeline workers!\n");
+        launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, "Failed to start server queries");
+        launcher->PostScanEvent(SCAN_EVENT_COMPLETE);
+        return 0;
+    }
 
-      
-            info.ping = launcher->queryManager->PingServer(addr.first, addr.second);
+    std::string statusMsg = "Querying " + std::to_string(totalServers) + " servers for details...";
+    launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, statusMsg);
+    OutputDebugStringA((statusMsg + "\n").c_str());
 
-        
-            if (info.ping > 5000) {
-                info.ping = -1; 
-            }
+    std::chrono::steady_clock::time_point lastReport = std::chrono::steady_clock::now();
+    int lastProgress = 20;
+    int lastAdded = 0;
+    int lastModded = 0;
 
-          
-            info.isFavorite = launcher->favoritesManager->IsFavorite(addr.first, addr.second);
+    auto reportProgress = [&](bool force) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!force && now - lastReport < std::chrono::milliseconds(SCAN_REPORT_INTERVAL_MS)) return;
+        lastReport = now;
 
-         
-            info.lastUpdated = time(nullptr);
-            info.country = launcher->GetCountryFromIP(addr.first);
+        int processedServers = window.processed.load();
+        int added = addedServers.load();
+        int modded = moddedServers.load();
 
-     
-            {
-                std::lock_guard<std::mutex> lock(launcher->serverMutex);
-                launcher->servers.push_back(info);
-            }
+        int progress = 20 + (processedServers * 75) / totalServers;
+        if (progress != lastProgress) {
+            launcher->PostScanEvent(SCAN_EVENT_PROGRESS, progress);
+            lastProgress = progress;
+        }
 
-            successfulQueries++;
-            OutputDebugStringA(("Successfully added server: " + info.name + "\n").c_str());
+        if (added != lastAdded || modded != lastModded) {
+            launcher->PostScanEvent(SCAN_EVENT_SERVERS_ADDED);
+            lastAdded = added;
+            lastModded = modded;
+        }
 
-        
-            if (successfulQueries % 3 == 0) {
-                PostMessage(launcher->hWnd, WM_REFRESH_PARTIAL, 0, 0);
-            }
+        std::string statusUpdate;
+        if (processedServers >= totalServers) {
+            PipelineStageStats rules = rulesStage.GetStats();
+            statusUpdate = "Resolving mods " + std::to_string(rules.processed) + "/" +
+                std::to_string(rules.queue.pushed) + " (" + std::to_string(modded) + " modded)";
         }
         else {
-            OutputDebugStringA(("Server did not respond: " + addr.first + ":" + std::to_string(addr.second) + "\n").c_str());
+            statusUpdate = "Processed " + std::to_string(processedServers) + "/" +
+                std::to_string(totalServers) + " (" + std::to_string(added) + " responding)";
         }
+        launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, statusUpdate);
+        OutputDebugStringA((statusUpdate + "\n").c_str());
+    };
 
-        processedServers++;
+    auto drainStage = [&](auto& stage) {
+        stage.Close();
+        while (!stage.IsFinished() && !cancel->Wait(SCAN_REPORT_INTERVAL_MS)) {
+            reportProgress(false);
+        }
+        stage.Join();
+    };
 
-      
-        int progress = 20 + (processedServers * 75) / totalServers;
-        PostMessage(launcher->hWnd, WM_UPDATE_PROGRESS, progress, 0);
+    std::chrono::steady_clock::time_point nextLaunch = std::chrono::steady_clock::now();
+    for (ServerAddress& addr : serverAddresses) {
+        while (!cancel->IsCancelled() && !window.slots.try_acquire_for(std::chrono::milliseconds(SCAN_REPORT_INTERVAL_MS))) {
+            reportProgress(false);
+        }
+        if (cancel->IsCancelled()) break;
 
-      
-        if (processedServers % 5 == 0) {
-            std::string statusUpdate = "Processed " + std::to_string(processedServers) + "/" +
-                std::to_string(totalServers) + " (" +
-                std::to_string(successfulQueries) + " responding)";
-            PostMessage(launcher->hWnd, WM_USER + 200, 0, (LPARAM)statusUpdate.c_str());
-            OutputDebugStringA((statusUpdate + "\n").c_str());
+        nextLaunch = (std::max)(nextLaunch, std::chrono::steady_clock::now()) + launchSpacing;
+        long long waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(nextLaunch - std::chrono::steady_clock::now()).count();
+        if (waitMs > 0 && cancel->Wait(static_cast<DWORD>(waitMs))) {
+            window.slots.release();
+            break;
         }
 
-     
-        int baseDelay = launcher->configManager->GetInt("queryDelay", 50);
-        Sleep(baseDelay);
+        window.active++;
+        launcher->ScanServerAsync(addr.first, addr.second, window, enrichStage.Input()).Detach();
+        reportProgress(false);
+    }
+
+    while (window.active.load() > 0 && !cancel->Wait(10)) {
+        reportProgress(false);
+    }
+    while (window.active.load() > 0) {
+        Sleep(10);
     }
 
+    drainStage(enrichStage);
+    drainStage(rulesStage);
+
+    if (cancel->IsCancelled()) {
+        OutputDebugStringA("=== REFRESH THREAD CANCELLED ===\n");
+        return 0;
+    }
+
+    reportProgress(true);
+
 
     {
         std::lock_guard<std::mutex> lock(launcher->serverMutex);
         std::string finalStatus = "Found " + std::to_string(launcher->servers.size()) + " servers";
-        PostMessage(launcher->hWnd, WM_USER + 200, 0, (LPARAM)finalStatus.c_str());
+        launcher->PostScanEvent(SCAN_EVENT_STATUS, 0, finalStatus);
         OutputDebugStringA((finalStatus + "\n").c_str());
+
+        size_t serverBytes = launcher->servers.GetMemoryUsage();
+        DebugLogFormat("Server list: %d servers, %d KB (%d bytes/server)",
+            static_cast<int>(launcher->servers.size()), static_cast<int>(serverBytes / 1024),
+            launcher->servers.empty() ? 0 : static_cast<int>(serverBytes / launcher->servers.size()));
     }
 
 
-    PostMessage(launcher->hWnd, WM_UPDATE_PROGRESS, 100, 0);
-    PostMessage(launcher->hWnd, WM_REFRESH_COMPLETE, 0, 0);
+    OutputDebugStringA((launcher->queryEngine->GetStats().Format() + "\n").c_str());
+    OutputDebugStringA((enrichStage.GetStats().Format() + "\n").c_str());
+    OutputDebugStringA((rulesStage.GetStats().Format() + "\n").c_str());
+    OutputDebugStringA((scanArena.FormatStats() + "\n").c_str());
+
+    SingleFlightStats queryStats = rulesFlights->GetStats();
+    DebugLogFormat("Rules queries: %d sent, %d joined in-flight, %d served from cache",
+        static_cast<int>(queryStats.sent), static_cast<int>(queryStats.joined), static_cast<int>(queryStats.cached));
+
+    launcher->PostScanEvent(SCAN_EVENT_PROGRESS, 100);
+    launcher->PostScanEvent(SCAN_EVENT_COMPLETE);
 
     OutputDebugStringA("=== REFRESH THREAD COMPLETED ===\n");
     return 0;
@@ -1025,6 +1122,19 @@ void DayZLauncher::CreateFilterPanel() {
     CreateVersionDropdown(15, yPos);
     yPos += spacing;
 
+
+    CreateFilterLabel(hMinPlayersLabel, L"Min players:", 15, yPos, 110);
+    CreateFilterLabel(hMaxPingLabel, L"Max ping:", 135, yPos, 110);
+    yPos += 22;
+    CreateFilterEditBox(hMinPlayersEdit, IDC_MIN_PLAYERS_EDIT, 15, yPos, 110, 20);
+    CreateFilterEditBox(hMaxPingEdit, IDC_MAX_PING_EDIT, 135, yPos, 110, 20);
+    for (HWND numberEdit : { hMinPlayersEdit, hMaxPingEdit }) {
+        LONG_PTR style = GetWindowLongPtr(numberEdit, GWL_STYLE);
+        SetWindowLongPtr(numberEdit, GWL_STYLE, style | ES_NUMBER);
+        SendMessage(numberEdit, EM_SETLIMITTEXT, 4, 0);
+    }
+    yPos += spacing;
+
   
     CreateFilterLabel(hFilterOptionsLabel, L"Filters:", 15, yPos, 100);
     yPos += 25;
@@ -1078,197 +1188,91 @@ void DayZLauncher::CreateVersionDropdown(int x, int y) {
     HINSTANCE hInst = GetModuleHandle(nullptr);
 
     hFilterVersion = CreateWindow(L"COMBOBOX", L"",
-        WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | CBS_SORT | WS_VSCROLL,
+        WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | WS_VSCROLL,
         x, y, 240, 200,
         hFilterPanel, (HMENU)IDC_FILTER_VERSION, hInst, nullptr);
 
     SendMessage(hFilterVersion, CB_ADDSTRING, 0, (LPARAM)L"All Versions");
-
-    const wchar_t* versions[] = {
-        L"1.0.150192", L"1.10.153398", L"1.15.154355", L"1.18.154960", L"1.18.155001",
-        L"1.18.155069", L"1.19.155430", L"1.20.155981", L"1.21.156300", L"1.22.156718",
-        L"1.23.156951", L"1.23.157045", L"1.24.157623", L"1.24.157828", L"1.25.158199",
-        L"1.25.158396", L"1.25.158593", L"1.26.158898", L"1.26.158964", L"1.26.159040",
-        L"1.27.159420", L"1.27.159586", L"1.27.159674", L"1.28.159876", L"1.28.159992",
-        L"1.28.160049"
-    };
-
-    for (int i = 0; i < sizeof(versions) / sizeof(versions[0]); i++) {
-        SendMessage(hFilterVersion, CB_ADDSTRING, 0, (LPARAM)versions[i]);
-    }
+    SendMessage(hFilterVersion, CB_SETITEMDATA, 0, STRINGPOOL_EMPTY_ID);
 
     SendMessage(hFilterVersion, CB_SETCURSEL, 0, 0);
 }
 
 
+void DayZLauncher::UpdateFilteredServerList() {
+    RequestFilterPass(false);
+}
 
 
-bool DayZLauncher::PassesFilters(const ServerInfo& server) const {
-
-    if (!searchFilter.empty()) {
-        std::string serverName = server.name;
-        std::string serverMap = server.map;
-        std::string serverIP = server.ip;
-        std::transform(serverName.begin(), serverName.end(), serverName.begin(), ::tolower);
-        std::transform(serverMap.begin(), serverMap.end(), serverMap.begin(), ::tolower);
-        std::transform(serverIP.begin(), serverIP.end(), serverIP.begin(), ::tolower);
-
-        bool found = (serverName.find(searchFilter) != std::string::npos) ||
-            (serverMap.find(searchFilter) != std::string::npos) ||
-            (serverIP.find(searchFilter) != std::string::npos);
 
-        if (!found) return false;
-    }
+void DayZLauncher::CreateMapDropdown(int x, int y) {
+    HINSTANCE hInst = GetModuleHandle(nullptr);
 
 
-    if (!mapFilter.empty()) {
-        std::string serverMap = server.map;
-        std::transform(serverMap.begin(), serverMap.end(), serverMap.begin(), ::tolower);
+    hFilterMap = CreateWindow(L"COMBOBOX", L"",
+        WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | WS_VSCROLL,
+        x, y, 240, 200,
+        hFilterPanel, (HMENU)IDC_FILTER_MAP, hInst, nullptr);
 
-        if (serverMap != mapFilter) return false;
-    }
 
+    SendMessage(hFilterMap, CB_ADDSTRING, 0, (LPARAM)L"All Maps");
+    SendMessage(hFilterMap, CB_SETITEMDATA, 0, STRINGPOOL_EMPTY_ID);
 
-    if (!versionFilter.empty()) {
-        if (server.version.find(versionFilter) == std::string::npos) return false;
-    }
+    SendMessage(hFilterMap, CB_SETCURSEL, 0, 0);
+}
 
 
-    if (filterFlags & FILTER_SHOW_FAVORITES) {
-        if (!server.isFavorite) return false;
-    }
-    if (filterFlags & FILTER_HIDE_PASSWORD) {
-        if (server.isPassworded) return false;
-    }
-    if (filterFlags & FILTER_ONLINE_ONLY) {
-        if (server.ping == -1) return false;
-    }
-    if (filterFlags & FILTER_NOT_FULL) {
-        if (server.players >= server.maxPlayers && server.maxPlayers > 0) return false;
-    }
-    if (filterFlags & FILTER_SHOW_MODDED) {
-        if (server.mods.empty()) return false;
-    }
-    if (filterFlags & FILTER_SHOW_PLAYED) {
-        bool hasPlayed = false;
-        if (favoritesManager) {
-            const auto& history = favoritesManager->GetRecentServers();
-            for (const auto& hist : history) {
-                if (hist.ip == server.ip && hist.port == server.port && hist.connectionCount > 0) {
-                    hasPlayed = true;
-                    break;
-                }
-            }
-        }
-        if (!hasPlayed) return false;
-    }
+StringId DayZLauncher::GetSelectedFacet(HWND combo) const {
+    if (!combo || !IsWindow(combo)) return STRINGPOOL_EMPTY_ID;
 
-    return true;
+    int selected = static_cast<int>(SendMessage(combo, CB_GETCURSEL, 0, 0));
+    if (selected == CB_ERR) return STRINGPOOL_EMPTY_ID;
+    return static_cast<StringId>(SendMessage(combo, CB_GETITEMDATA, selected, 0));
 }
 
+void DayZLauncher::PopulateFacetDropdown(HWND combo, const wchar_t* allLabel, const std::vector<FacetCounts::Entry>& entries,
+    std::vector<FacetCounts::Entry>& shown, bool capitalize) {
+    if (!combo || !IsWindow(combo)) return;
+    if (entries == shown || SendMessage(combo, CB_GETDROPPEDSTATE, 0, 0)) return;
 
-void DayZLauncher::UpdateFilteredServerList() {
-    if (!hServerList || !IsWindow(hServerList)) return;
-
-    OutputDebugStringA("=== UPDATE FILTERED SERVER LIST ===\n");
+    StringId selected = GetSelectedFacet(combo);
+    bool selectedListed = selected == STRINGPOOL_EMPTY_ID;
 
+    SendMessage(combo, WM_SETREDRAW, FALSE, 0);
+    SendMessage(combo, CB_RESETCONTENT, 0, 0);
+    SendMessage(combo, CB_ADDSTRING, 0, (LPARAM)allLabel);
+    SendMessage(combo, CB_SETITEMDATA, 0, STRINGPOOL_EMPTY_ID);
+    SendMessage(combo, CB_SETCURSEL, 0, 0);
 
-    ListView_DeleteAllItems(hServerList);
-
-    std::lock_guard<std::mutex> lock(serverMutex);
+    auto addEntry = [&](StringId id, uint32_t count) {
+        std::string name = InternedString::FromId(id).str();
+        if (capitalize && !name.empty()) {
+            name[0] = static_cast<char>(toupper(static_cast<unsigned char>(name[0])));
+        }
+        std::wstring label = StringToWString(name) + L" (" + std::to_wstring(count) + L")";
+        int index = static_cast<int>(SendMessage(combo, CB_ADDSTRING, 0, (LPARAM)label.c_str()));
+        SendMessage(combo, CB_SETITEMDATA, index, id);
+        if (id == selected) {
+            SendMessage(combo, CB_SETCURSEL, index, 0);
+        }
+    };
 
-    if (servers.empty()) {
-        UpdateStatusBar("No servers loaded - click 'Refresh Servers' to load servers");
-        return;
+    for (const auto& entry : entries) {
+        if (entry.first == selected) selectedListed = true;
+        addEntry(entry.first, entry.second);
     }
-
-    int filteredCount = 0;
-    int totalCount = static_cast<int>(servers.size());
-
-    OutputDebugStringA(("Total servers available: " + std::to_string(totalCount) + "\n").c_str());
-    OutputDebugStringA(("Current filters: search='" + searchFilter + "', map='" + mapFilter + "', flags=" + std::to_string(filterFlags) + "\n").c_str());
-
-    for (const auto& server : servers) {
-        if (PassesFilters(server)) {
-       
-            LVITEM lvi = {};
-            lvi.mask = LVIF_TEXT;
-            lvi.iItem = filteredCount;
-            lvi.iSubItem = 0;
-
-            std::wstring serverName = StringToWString(server.name);
-            lvi.pszText = const_cast<LPWSTR>(serverName.c_str());
-            int listItemIndex = ListView_InsertItem(hServerList, &lvi);
-
-            if (listItemIndex != -1) {
-              
-                SetListViewItemText(listItemIndex, 1, StringToWString(server.map));
-
-                std::wstring playerText = std::to_wstring(server.players) + L"/" + std::to_wstring(server.maxPlayers);
-                SetListViewItemText(listItemIndex, 2, playerText);
-
-                std::wstring pingText = (server.ping == -1) ? L"N/A" : std::to_wstring(server.ping) + L"ms";
-                SetListViewItemText(listItemIndex, 3, pingText);
-
-                std::string address = server.ip + ":" + std::to_string(server.port);
-                SetListViewItemText(listItemIndex, 4, StringToWString(address));
-
-                SetListViewItemText(listItemIndex, 5, StringToWString(server.version));
-
-                filteredCount++;
-            }
-        }
+    if (!selectedListed) {
+        addEntry(selected, 0);
     }
 
-    std::string statusMsg = "Showing " + std::to_string(filteredCount) + " of " + std::to_string(totalCount) + " servers";
-    UpdateStatusBar(statusMsg);
-
-    OutputDebugStringA(("Filter result: " + std::to_string(filteredCount) + " servers pass filters\n").c_str());
+    SendMessage(combo, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(combo, nullptr, TRUE);
+    shown = entries;
 }
 
-
-
-void DayZLauncher::CreateMapDropdown(int x, int y) {
-    HINSTANCE hInst = GetModuleHandle(nullptr);
-
-
-    hFilterMap = CreateWindow(L"COMBOBOX", L"",
-        WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | CBS_SORT | WS_VSCROLL,
-        x, y, 240, 200,
-        hFilterPanel, (HMENU)IDC_FILTER_MAP, hInst, nullptr);
-
-
-    SendMessage(hFilterMap, CB_ADDSTRING, 0, (LPARAM)L"All Maps");
-
-
-    const wchar_t* maps[] = {
-        L"Alteria", L"Anastara", L"Andromeda_map", L"Antonia", L"Arcadia", L"Arland",
-        L"Armst_czoremake", L"Arsteinen", L"Arsteinen_snow", L"Ashesandblood_map", L"Avalon",
-        L"Badg_nyheim", L"Banov", L"Banovfrost", L"Barrington", L"Bearsland", L"Belozersknpson",
-        L"Bitterroot", L"Broumovsko", L"Burnham", L"Burnhamwinter", L"Caldera", L"Chernarus",
-        L"Chernarus2", L"Chernarus+", L"Chernarusplus", L"Chernarusplusgloom", L"Chernarusredux",
-        L"Dayz24_battleroyale_map", L"Dayz24_deathmatch_summer_map", L"Deadfall", L"Deerisle",
-        L"Dimaiden", L"Dma_maps_old", L"Dmmap", L"Doorcounty", L"Dz_map", L"Eden", L"Elmar_island",
-        L"Enoch", L"Esseker", L"Eternal", L"Exclusion_zone", L"Exclusionzone", L"Exclusionzoneplus",
-        L"Fallout_map", L"Fallujah", L"Fenix_emptiness", L"Fenwickharbor", L"Flatpack", L"Fogfall",
-        L"Frostskod", L"Green county", L"Greencounty", L"Hashima", L"Hom_worldmap", L"Hrp_zone",
-        L"Iztek", L"Japan", L"Kalksee", L"Kuba", L"Lincoln_county_war", L"Livonia", L"Lux",
-        L"Mecklenburg", L"Medieval_dayz", L"Melkart", L"Metropolis", L"Muerta_islands",
-        L"Mysteryisland", L"Namalsk", L"Newsland", L"Newyork", L"Nihchernobyl", L"Noobless",
-        L"Northtakistan", L"Nukezone", L"Nyheim", L"Onforin", L"Osek", L"Pnw", L"Pripyat",
-        L"Pulsemetromap", L"Queenstown_newzealand", L"Raman", L"Rhengau", L"Rio_map", L"Ros",
-        L"Rostow", L"Sahinkaya", L"Sahrani", L"Sakhal", L"Sanfranciscobayarea", L"Santacruz",
-        L"Sarov", L"Shauwaki_islands", L"Siberia", L"Stuartisland", L"Swansisland", L"Tsal",
-        L"Takistanplus", L"Tavllave", L"Taviana", L"Theprojectialland", L"Thezone", L"Togenia",
-        L"Tpdm", L"Underworld", L"Utes", L"Valning", L"Vela", L"Visterrains_islands_map",
-        L"Volcano", L"Wabamun", L"Wastelandz", L"Yiprit", L"Zaha", L"Zelador", L"Zentkamap", L"Zona"
-    };
-
-    for (int i = 0; i < sizeof(maps) / sizeof(maps[0]); i++) {
-        SendMessage(hFilterMap, CB_ADDSTRING, 0, (LPARAM)maps[i]);
-    }
-
-    SendMessage(hFilterMap, CB_SETCURSEL, 0, 0);
+void DayZLauncher::UpdateFacetDropdowns(const FilterResult& result) {
+    PopulateFacetDropdown(hFilterMap, L"All Maps", result.mapFacets, shownMapFacets, true);
+    PopulateFacetDropdown(hFilterVersion, L"All Versions", result.versionFacets, shownVersionFacets, false);
 }
 
 
@@ -1507,13 +1511,9 @@ std::string DayZLauncher::FormatServerTime(const ServerInfo& server) {
 std::string DayZLauncher::FormatPlayedStatus(const ServerInfo& server) {
 
     if (favoritesManager) {
-        const auto& history = favoritesManager->GetRecentServers();
-        for (const auto& hist : history) {
-            if (hist.ip == server.ip && hist.port == server.port) {
-                if (hist.connectionCount > 0) {
-                    return std::to_string(hist.connectionCount) + "x";
-                }
-            }
+        int connectionCount = favoritesManager->GetPlayedSnapshot()->GetConnectionCount(server.ip, server.port);
+        if (connectionCount > 0) {
+            return std::to_string(connectionCount) + "x";
         }
     }
     return "";
@@ -1607,12 +1607,7 @@ void DayZLauncher::MarkServerRefreshed(const std::string& ip, int port) {
 }
 
 ServerInfo* DayZLauncher::FindServerByAddress(const std::string& ip, int port) {
-    for (auto& server : servers) {
-        if (server.ip == ip && server.port == port) {
-            return &server;
-        }
-    }
-    return nullptr;
+    return servers.Find(ip, port);
 }
 
 void DayZLauncher::ForceSaveDayZPath() {
@@ -1870,6 +1865,8 @@ std::string DayZLauncher::HttpGet(const std::wstring& host, const std::wstring&
     WinHttpSetOption(hRequest, WINHTTP_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout));
     WinHttpSetOption(hRequest, WINHTTP_OPTION_SEND_TIMEOUT, &timeout, sizeof(timeout));
 
+    CancellationToken::Registration abortRequest(CancellationToken::Current(), [hRequest]() { WinHttpCloseHandle(hRequest); });
+
     if (WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
         WINHTTP_NO_REQUEST_DATA, 0, 0, 0)) {
 
@@ -1890,7 +1887,9 @@ std::string DayZLauncher::HttpGet(const std::wstring& host, const std::wstring&
         }
     }
 
-    WinHttpCloseHandle(hRequest);
+    if (abortRequest.Release()) {
+        WinHttpCloseHandle(hRequest);
+    }
     WinHttpCloseHandle(hConnect);
     WinHttpCloseHandle(hSession);
 
@@ -2253,7 +2252,7 @@ std::vector<std::string> DayZLauncher::ParseModString(const std::string& modStri
 
 void DayZLauncher::SortServersByColumn(int column) {
     if (column < 0 || column > 5) return;
-    if (servers.empty()) return;
+    if (servers.GetSnapshot()->empty()) return;
     if (currentSortColumn == column) {
         sortAscending = !sortAscending;
     }
@@ -2262,60 +2261,8 @@ void DayZLauncher::SortServersByColumn(int column) {
         currentSortColumn = column;
     }
 
-
-
-    std::sort(servers.begin(), servers.end(),
-        [column, this](const ServerInfo& a, const ServerInfo& b) -> bool {
-
-            try {
-                int compareResult = 0;
-
-                switch (column) {
-                case SORT_NAME: 
-                    compareResult = a.name.compare(b.name);
-                    break;
-                case SORT_MAP: 
-                    compareResult = a.map.compare(b.map);
-                    break;
-                case SORT_PLAYERS: 
-                    if (a.players < b.players) compareResult = -1;
-                    else if (a.players > b.players) compareResult = 1;
-                    else compareResult = 0;
-                    break;
-                case SORT_PING:
-                    if (a.ping == -1 && b.ping == -1) compareResult = 0;
-                    else if (a.ping == -1) compareResult = 1;
-                    else if (b.ping == -1) compareResult = -1;
-                    else {
-                        if (a.ping < b.ping) compareResult = -1;
-                        else if (a.ping > b.ping) compareResult = 1;
-                        else compareResult = 0;
-                    }
-                    break;
-                case SORT_IP: 
-                    compareResult = a.ip.compare(b.ip);
-                    break;
-                case SORT_VERSION: 
-                    compareResult = a.version.compare(b.version);
-                    break;
-                default:
-                    return false; 
-                }
-
-          
-                if (sortAscending) {
-                    return compareResult < 0;
-                }
-                else {
-                    return compareResult > 0;
-                }
-            }
-            catch (...) {
-                return false;
-            }
-        });
-
-    PopulateServerList();
+    ServerSorter::Promote(sortKeys, SortSpec{ column, sortAscending });
+    RequestFilterPass(false);
 }
 
 void DayZLauncher::PopulateServerList() {
@@ -2324,90 +2271,8 @@ void DayZLauncher::PopulateServerList() {
 
 
 
-std::vector<ServerInfo> DayZLauncher::GetFilteredServers() const {
-    std::vector<ServerInfo> filtered;
-
-    try {
-        if (currentTab == TAB_FAVORITES) {
-            const auto& favorites = favoritesManager->GetFavorites();
-
-            for (const auto& favorite : favorites) {
-                bool foundLive = false;
-                for (const ServerInfo& server : servers) {
-                    if (server.ip == favorite.ip && server.port == favorite.port) {
-                        ServerInfo favoriteServer = server;
-                        favoriteServer.isFavorite = true; 
-                        filtered.push_back(favoriteServer);
-                        foundLive = true;
-                        break;
-                    }
-                }
-
-           
-                if (!foundLive) {
-                    ServerInfo offlineServer;
-                    offlineServer.name = favorite.name + " (OFFLINE)";
-                    offlineServer.ip = favorite.ip;
-                    offlineServer.port = favorite.port;
-                    offlineServer.map = "Unknown";
-                    offlineServer.players = 0;
-                    offlineServer.maxPlayers = 0;
-                    offlineServer.ping = -1;
-                    offlineServer.isOfficial = false;
-                    offlineServer.isFavorite = true;
-                    offlineServer.version = "Unknown";
-                    offlineServer.lastUpdated = time(nullptr);
-
-                    filtered.push_back(offlineServer);
-                }
-            }
-            return filtered;
-        }
-
-    
-        for (const ServerInfo& server : servers) {
-            try {
-           
-                if (currentTab == TAB_OFFICIAL && !server.isOfficial) continue;
-                if (currentTab == TAB_COMMUNITY && server.isOfficial) continue;
-                if (currentTab == TAB_LAN) {
-                    if (!IsLANAddress(server.ip)) continue;
-                }
-
-                if (PassesFilters(server)) {
-                    filtered.push_back(server);
-                }
-            }
-            catch (...) {
-                continue;
-            }
-        }
-    }
-    catch (...) {
-        return std::vector<ServerInfo>();
-    }
-
-    return filtered;
-}
-
-
 bool DayZLauncher::IsLANAddress(const std::string& ip) const {
-    if (ip.substr(0, 3) == "10.") return true;
-    if (ip.substr(0, 8) == "192.168.") return true;
-    if (ip.substr(0, 4) == "127.") return true;
-    if (ip.substr(0, 4) == "172.") {
-        size_t secondDot = ip.find('.', 4);
-        if (secondDot != std::string::npos) {
-            std::string secondOctet = ip.substr(4, secondDot - 4);
-            try {
-                int octet = std::stoi(secondOctet);
-                if (octet >= 16 && octet <= 31) return true;
-            }
-            catch (...) {}
-        }
-    }
-
-    return false;
+    return ServerUtils::IsLANAddress(ip);
 }
 
 
@@ -2586,10 +2451,9 @@ void DayZLauncher::OnServerSelected() {
     EnableWindow(hFavoriteBtn, hasSelection);
 
     if (hasSelection) {
-     
-        std::vector<ServerInfo> filteredServers = GetFilteredServers();
-        if (selected >= 0 && selected < static_cast<int>(filteredServers.size())) {
-            const ServerInfo& selectedServer = filteredServers[selected];
+        ServerRecordRef server = GetServerAtRow(selected);
+        if (server) {
+            const ServerInfo& selectedServer = *server;
 
        
             if (selectedServer.isFavorite) {
@@ -2629,7 +2493,7 @@ void DayZLauncher::DebugFavorites() {
 
 
 void DayZLauncher::JoinServer() {
-    ServerInfo* selectedServer = GetSelectedServer();
+    ServerRecordRef selectedServer = GetSelectedServer();
     if (!selectedServer) {
         UpdateStatusBar("No server selected!");
         return;
@@ -2677,27 +2541,8 @@ void DayZLauncher::JoinServer() {
     }
 
  
-    if (!selectedServer->mods.empty()) {
-        std::string modList;
-        for (size_t i = 0; i < selectedServer->mods.size(); ++i) {
-            if (i > 0) modList += ";";
-
-            std::string mod = selectedServer->mods[i];
-
-     
-            if (!mod.empty() && mod[0] == '@') {
-                mod = mod.substr(1);
-            }
-
-            size_t hyphenPos = mod.find('-');
-            if (hyphenPos != std::string::npos) {
-                mod = mod.substr(0, hyphenPos);
-            }
-
-            if (!mod.empty() && std::all_of(mod.begin(), mod.end(), ::isdigit)) {
-                modList += "@" + mod;  
-            }
-        }
+    if (selectedServer->hasMods()) {
+        std::string modList = selectedServer->mods->ToLaunchArgument();
 
         if (!modList.empty()) {
             arguments.push_back("-mod=" + modList);  
@@ -2722,7 +2567,7 @@ void DayZLauncher::JoinServer() {
     OutputDebugStringA(("DayZ Working Directory: " + dayzDir + "\n").c_str());
 
 
-    bool steamLaunchSuccess = LaunchViaSteam(selectedServer);
+    bool steamLaunchSuccess = LaunchViaSteam(selectedServer.get());
     if (steamLaunchSuccess) {
         return; 
     }
@@ -2755,8 +2600,8 @@ void DayZLauncher::JoinServer() {
 
     if (success) {
         std::string successMsg = "DayZ launched successfully - connecting to " + selectedServer->name;
-        if (!selectedServer->mods.empty()) {
-            successMsg += " with " + std::to_string(selectedServer->mods.size()) + " mods";
+        if (selectedServer->hasMods()) {
+            successMsg += " with " + std::to_string(selectedServer->mods->size()) + " mods";
         }
         UpdateStatusBar(successMsg);
         favoritesManager->AddToHistory(*selectedServer);
@@ -2796,7 +2641,7 @@ void DayZLauncher::JoinServer() {
     }
 }
 
-bool DayZLauncher::LaunchViaSteam(ServerInfo* server) {
+bool DayZLauncher::LaunchViaSteam(const ServerInfo* server) {
     try {
         UpdateStatusBar("Attempting Steam launch...");
 
@@ -2814,26 +2659,8 @@ bool DayZLauncher::LaunchViaSteam(ServerInfo* server) {
         }
 
 
-        if (!server->mods.empty()) {
-            std::string modList;
-            for (size_t i = 0; i < server->mods.size(); ++i) {
-                if (i > 0) modList += ";";
-
-                std::string mod = server->mods[i];
-                if (!mod.empty() && mod[0] == '@') {
-                    mod = mod.substr(1);
-                }
-
-        
-                size_t hyphenPos = mod.find('-');
-                if (hyphenPos != std::string::npos) {
-                    mod = mod.substr(0, hyphenPos);
-                }
-
-                if (std::all_of(mod.begin(), mod.end(), ::isdigit)) {
-                    modList += "@" + mod;
-                }
-            }
+        if (server->hasMods()) {
+            std::string modList = server->mods->ToLaunchArgument();
 
             if (!modList.empty()) {
                 steamCmd += "-mod=" + modList + "%20";
@@ -2906,8 +2733,8 @@ bool DayZLauncher::DetectOfficialServer(const std::string& name, const std::stri
 }
 
 
-bool DayZLauncher::ExtractModsFromRules(const A2SRulesResponse& rules, std::vector<std::string>& mods) {
-    mods.clear();
+bool DayZLauncher::ExtractModsFromRules(const A2SRulesResponse& rules, ModSetRef& mods) {
+    mods.reset();
 
 
     std::vector<std::string> modFields = {
@@ -2936,7 +2763,7 @@ bool DayZLauncher::ExtractModsFromRules(const A2SRulesResponse& rules, std::vect
                 std::vector<std::string> foundMods = ExtractWorkshopIDs(rule.value);
 
                 if (!foundMods.empty()) {
-                    mods.insert(mods.end(), foundMods.begin(), foundMods.end());
+                    mods = ModSetTable::Instance().FromWorkshopStrings(foundMods);
                     OutputDebugStringA(("Extracted " + std::to_string(foundMods.size()) + " valid Workshop IDs\n").c_str());
                     return true;
                 }
@@ -3043,7 +2870,7 @@ std::vector<std::string> DayZLauncher::ExtractWorkshopIDs(const std::string& mod
     return workshopIDs;
 }
 
-bool DayZLauncher::QueryDZSAServerMods(const std::string& ip, int port, std::vector<std::string>& mods) {
+bool DayZLauncher::QueryDZSAServerMods(const std::string& ip, int port, ModSetRef& mods) {
     try {
 
         std::wstring host = L"dayzsalauncher.com";
@@ -3061,9 +2888,9 @@ bool DayZLauncher::QueryDZSAServerMods(const std::string& ip, int port, std::vec
      
         std::string modsField = ParseJsonString(response, "mods");
         if (!modsField.empty()) {
-            mods = ExtractWorkshopIDs(modsField);
-            OutputDebugStringA(("DZSA found " + std::to_string(mods.size()) + " mods\n").c_str());
-            return !mods.empty();
+            mods = ModSetTable::Instance().FromWorkshopStrings(ExtractWorkshopIDs(modsField));
+            OutputDebugStringA(("DZSA found " + std::to_string(mods ? mods->size() : 0) + " mods\n").c_str());
+            return mods != nullptr;
         }
 
   
@@ -3071,9 +2898,9 @@ bool DayZLauncher::QueryDZSAServerMods(const std::string& ip, int port, std::vec
         for (const std::string& field : altFields) {
             std::string altMods = ParseJsonString(response, field);
             if (!altMods.empty()) {
-                mods = ExtractWorkshopIDs(altMods);
-                if (!mods.empty()) {
-                    OutputDebugStringA(("DZSA found mods in " + field + ": " + std::to_string(mods.size()) + "\n").c_str());
+                mods = ModSetTable::Instance().FromWorkshopStrings(ExtractWorkshopIDs(altMods));
+                if (mods) {
+                    OutputDebugStringA(("DZSA found mods in " + field + ": " + std::to_string(mods->size()) + "\n").c_str());
                     return true;
                 }
             }
@@ -3211,20 +3038,20 @@ std::string DayZLauncher::GetCountryFromIP(const std::string& ip) {
 
 
 void DayZLauncher::AddToFavorites() {
-    ServerInfo* selectedServer = GetSelectedServer();
+    ServerRecordRef selectedServer = GetSelectedServer();
     if (selectedServer && !selectedServer->isFavorite) {
         favoritesManager->AddFavorite(*selectedServer);
-        selectedServer->isFavorite = true;
+        SetServerFavorite(*selectedServer, true);
         PopulateServerList();
         UpdateStatusBar("Added " + selectedServer->name + " to favorites");
     }
 }
 
 void DayZLauncher::RemoveFromFavorites() {
-    ServerInfo* selectedServer = GetSelectedServer();
+    ServerRecordRef selectedServer = GetSelectedServer();
     if (selectedServer && selectedServer->isFavorite) {
         favoritesManager->RemoveFavorite(selectedServer->ip, selectedServer->port);
-        selectedServer->isFavorite = false;
+        SetServerFavorite(*selectedServer, false);
         PopulateServerList();
         UpdateStatusBar("Removed " + selectedServer->name + " from favorites");
     }
@@ -3314,6 +3141,63 @@ void DayZLauncher::OnRefreshComplete() {
     PopulateServerList();
     UpdateStatusBar("Ready");
     UpdateProgressBar(0);
+
+    ThreadPoolStats poolStats = threadPool->GetStats();
+    DebugLogFormat("Thread pool: %d threads, %d queued, %d active, %d completed, %d stolen, wait avg %.2f ms max %.2f ms, run avg %.2f ms",
+        static_cast<int>(poolStats.threads), static_cast<int>(poolStats.queued), static_cast<int>(poolStats.active),
+        static_cast<int>(poolStats.completed), static_cast<int>(poolStats.stolen),
+        poolStats.averageWaitMs, poolStats.maxWaitMs, poolStats.averageRunMs);
+}
+
+void DayZLauncher::PostScanEvent(ScanEventType type, int value, const std::string& text) {
+    ScanEvent event;
+    event.type = type;
+    event.value = value;
+    event.text = text;
+
+    while (!scanEvents.TryPush(event)) {
+        if (type != SCAN_EVENT_COMPLETE || !IsWindow(hWnd) || scanCancel->IsCancelled()) {
+            OutputDebugStringA("Scan event queue full, dropping event\n");
+            return;
+        }
+        Sleep(SCAN_DRAIN_INTERVAL_MS);
+    }
+}
+
+void DayZLauncher::DrainScanEvents() {
+    ScanEvent event;
+    std::string status;
+    int progress = -1;
+    int serversAdded = 0;
+    bool complete = false;
+
+    while (scanEvents.TryPop(event)) {
+        switch (event.type) {
+        case SCAN_EVENT_STATUS:
+            status = std::move(event.text);
+            break;
+        case SCAN_EVENT_PROGRESS:
+            progress = event.value;
+            break;
+        case SCAN_EVENT_SERVERS_ADDED:
+            serversAdded++;
+            break;
+        case SCAN_EVENT_COMPLETE:
+            complete = true;
+            break;
+        }
+    }
+
+    if (!status.empty()) UpdateStatusBar(status);
+    if (progress >= 0) OnUpdateProgress(progress);
+
+    if (complete) {
+        KillTimer(hWnd, IDT_SCAN_DRAIN);
+        OnRefreshComplete();
+    }
+    else if (serversAdded > 0) {
+        RequestFilterPass(false);
+    }
 }
 
 void DayZLauncher::EnableControls(bool enable) {
@@ -3325,7 +3209,7 @@ void DayZLauncher::EnableControls(bool enable) {
 
 
 void DayZLauncher::ShowServerContextMenu(POINT pt) {
-    ServerInfo* selectedServer = GetSelectedServer();
+    ServerRecordRef selectedServer = GetSelectedServer();
     if (!selectedServer) return;
 
     HMENU hMenu = CreatePopupMenu();
@@ -3357,7 +3241,7 @@ void DayZLauncher::ShowServerContextMenu(POINT pt) {
         break;
     case ID_SERVER_REFRESH:
     {
-        ServerInfo* selectedServer = g_launcher->GetSelectedServer();
+        ServerRecordRef selectedServer = g_launcher->GetSelectedServer();
         if (selectedServer) {
             g_launcher->RefreshSingleServer(selectedServer->ip, selectedServer->port);
             g_launcher->UpdateStatusBar("Refreshing server: " + selectedServer->name);
@@ -3380,7 +3264,7 @@ void DayZLauncher::ShowServerContextMenu(POINT pt) {
 }
 
 void DayZLauncher::CopyServerAddress() {
-    ServerInfo* selectedServer = GetSelectedServer();
+    ServerRecordRef selectedServer = GetSelectedServer();
     if (!selectedServer) return;
 
     std::string address = selectedServer->ip + ":" + std::to_string(selectedServer->port);
@@ -3401,7 +3285,7 @@ void DayZLauncher::CopyServerAddress() {
 }
 
 void DayZLauncher::ShowServerDetails() {
-    ServerInfo* selectedServer = GetSelectedServer();
+    ServerRecordRef selectedServer = GetSelectedServer();
     if (!selectedServer) return;
 
     std::wstring details = L"Server Information\n\n";
@@ -3435,10 +3319,10 @@ void DayZLauncher::ShowServerDetails() {
     details += selectedServer->isOfficial ? L"Official" : L"Community";
     details += L"\n";
 
-    if (!selectedServer->mods.empty()) {
-        details += L"\nMods (" + std::to_wstring(selectedServer->mods.size()) + L"):\n";
-        for (const auto& mod : selectedServer->mods) {
-            details += L"  • " + StringToWString(mod) + L"\n";
+    if (selectedServer->hasMods()) {
+        details += L"\nMods (" + std::to_wstring(selectedServer->mods->size()) + L"):\n";
+        for (WorkshopId mod : *selectedServer->mods) {
+            details += L"  • @" + std::to_wstring(mod) + L"\n";
         }
     }
     else {
@@ -3459,26 +3343,35 @@ void DayZLauncher::ToggleFavorite() {
         return;
     }
 
-    std::vector<ServerInfo> filteredServers = GetFilteredServers();
-    if (selected >= 0 && selected < static_cast<int>(filteredServers.size())) {
-        const ServerInfo& selectedServer = filteredServers[selected];
+    ServerRecordRef server = GetServerAtRow(selected);
+    if (!server) return;
 
-        if (selectedServer.isFavorite) {
-        
-            favoritesManager->RemoveFavorite(selectedServer.ip, selectedServer.port);
-            SetWindowText(hFavoriteBtn, L"Add Favorite");
-            UpdateStatusBar("Removed " + selectedServer.name + " from favorites");
-        }
-        else {
-       
-            favoritesManager->AddFavorite(selectedServer);
-            SetWindowText(hFavoriteBtn, L"Remove Favorite");
-            UpdateStatusBar("Added " + selectedServer.name + " to favorites");
-        }
+    const ServerInfo& selectedServer = *server;
+    if (selectedServer.isFavorite) {
+        favoritesManager->RemoveFavorite(selectedServer.ip, selectedServer.port);
+        SetServerFavorite(selectedServer, false);
+        SetWindowText(hFavoriteBtn, L"Add Favorite");
+        UpdateStatusBar("Removed " + selectedServer.name + " from favorites");
+    }
+    else {
+        favoritesManager->AddFavorite(selectedServer);
+        SetServerFavorite(selectedServer, true);
+        SetWindowText(hFavoriteBtn, L"Remove Favorite");
+        UpdateStatusBar("Added " + selectedServer.name + " to favorites");
+    }
 
+    PopulateServerList();
+}
 
-        PopulateServerList();
+void DayZLauncher::SetServerFavorite(const ServerInfo& server, bool favorite) {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    ServerInfo* live = servers.Find(server.ip, server.port);
+    if (live && live->isFavorite != favorite) {
+        live->isFavorite = favorite;
+        servers.Update(*live);
     }
+
+    threadPool->Post([this]() { favoritesManager->SaveFavorites(); });
 }
 
 
@@ -3487,60 +3380,56 @@ void DayZLauncher::FilterServers() {
 }
 
 
-ServerInfo* DayZLauncher::GetSelectedServer() {
+ServerRecordRef DayZLauncher::GetSelectedServer() {
     int selected = ListView_GetNextItem(hServerList, -1, LVNI_SELECTED);
     if (selected == -1) return nullptr;
 
-    std::lock_guard<std::mutex> lock(serverMutex);
+    return GetServerAtRow(selected);
+}
 
+ServerRecordRef DayZLauncher::GetServerAtRow(int row) {
+    if (row < 0) return nullptr;
 
     if (currentTab == TAB_FAVORITES) {
         const auto& favorites = favoritesManager->GetFavorites();
-        if (selected >= 0 && selected < static_cast<int>(favorites.size())) {
-            const auto& favorite = favorites[selected];
+        if (row < static_cast<int>(favorites.size())) {
+            const auto& favorite = favorites[row];
 
         
-            for (auto& server : servers) {
-                if (server.ip == favorite.ip && server.port == favorite.port) {
-                    return &server;
+            {
+                std::lock_guard<std::mutex> lock(serverMutex);
+                ServerInfo* liveServer = FindServerByAddress(favorite.ip, favorite.port);
+                if (liveServer) {
+                    return std::make_shared<const ServerInfo>(*liveServer);
                 }
             }
 
    
-            static ServerInfo tempServer;
-            tempServer.name = favorite.name;
-            tempServer.ip = favorite.ip;
-            tempServer.port = favorite.port;
-            tempServer.isFavorite = true;
-            tempServer.ping = -1;
-            tempServer.players = 0;
-            tempServer.maxPlayers = 0;
-            tempServer.map = "Unknown";
-            tempServer.version = "Unknown";
-            return &tempServer;
+            auto tempServer = std::make_shared<ServerInfo>();
+            tempServer->name = favorite.name;
+            tempServer->ip = favorite.ip;
+            tempServer->port = favorite.port;
+            tempServer->isFavorite = true;
+            tempServer->ping = -1;
+            tempServer->players = 0;
+            tempServer->maxPlayers = 0;
+            tempServer->map = "Unknown";
+            tempServer->version = "Unknown";
+            return tempServer;
         }
         return nullptr;
     }
 
 
-    std::vector<ServerInfo> filteredServers = GetFilteredServers();
-    if (selected >= 0 && selected < static_cast<int>(filteredServers.size())) {
-        for (auto& server : servers) {
-            if (server.ip == filteredServers[selected].ip &&
-                server.port == filteredServers[selected].port) {
-                return &server;
-            }
-        }
-    }
-
-    return nullptr;
+    if (!shownSnapshot) return nullptr;
+    return shownSnapshot->GetRef(listModel.GetId(static_cast<size_t>(row)));
 }
 
 
 
 
 
-void DayZLauncher::OnFilterChanged() {
+void DayZLauncher::OnFilterChanged(bool debounce) {
     OutputDebugStringA("=== OnFilterChanged START ===\n");
 
 
@@ -3558,32 +3447,30 @@ void DayZLauncher::OnFilterChanged() {
         }
     }
 
-    if (hFilterMap && IsWindow(hFilterMap)) {
-        int selectedMapIndex = SendMessage(hFilterMap, CB_GETCURSEL, 0, 0);
-        if (selectedMapIndex > 0) { 
-            wchar_t mapName[256] = { 0 };
-            int result = SendMessage(hFilterMap, CB_GETLBTEXT, selectedMapIndex, (LPARAM)mapName);
-            if (result != CB_ERR && wcslen(mapName) > 0) {
-                mapFilter = WStringToString(std::wstring(mapName));
-     
-                std::transform(mapFilter.begin(), mapFilter.end(), mapFilter.begin(), ::tolower);
-                OutputDebugStringA(("Map filter set to: '" + mapFilter + "'\n").c_str());
-            }
-        }
+    if (!searchQuery.Parse(searchFilter)) {
+        UpdateStatusBar("Filter: " + searchQuery.GetError());
+        searchQuery.SetSearchText(searchFilter);
     }
 
-  
-    if (hFilterVersion && IsWindow(hFilterVersion)) {
-        int selectedVersionIndex = SendMessage(hFilterVersion, CB_GETCURSEL, 0, 0);
-        if (selectedVersionIndex > 0) {
-            wchar_t versionName[256] = { 0 };
-            int result = SendMessage(hFilterVersion, CB_GETLBTEXT, selectedVersionIndex, (LPARAM)versionName);
-            if (result != CB_ERR && wcslen(versionName) > 0) {
-                versionFilter = WStringToString(std::wstring(versionName));
-            }
-        }
+    minPlayersFilter = 0;
+    maxPingFilter = 0;
+    try {
+        std::wstring minPlayersText = GetFilterText(hMinPlayersEdit);
+        std::wstring maxPingText = GetFilterText(hMaxPingEdit);
+        if (!minPlayersText.empty()) minPlayersFilter = std::stoi(minPlayersText);
+        if (!maxPingText.empty()) maxPingFilter = std::stoi(maxPingText);
+    }
+    catch (...) {
+        OutputDebugStringA("Invalid min players / max ping value\n");
+    }
+
+    mapFilter = InternedString::FromId(GetSelectedFacet(hFilterMap));
+    if (!mapFilter.empty()) {
+        OutputDebugStringA(("Map filter set to: '" + mapFilter.lower() + "'\n").c_str());
     }
 
+    versionFilter = InternedString::FromId(GetSelectedFacet(hFilterVersion));
+
     if (hFilterFavorites && IsWindow(hFilterFavorites) && SendMessage(hFilterFavorites, BM_GETCHECK, 0, 0) == BST_CHECKED) {
         filterFlags |= FILTER_SHOW_FAVORITES;
     }
@@ -3609,179 +3496,231 @@ void DayZLauncher::OnFilterChanged() {
         filterFlags |= FILTER_THIRD_PERSON;
     }
 
-    ApplyFiltersAndUpdate();
+    RequestFilterPass(debounce);
 
     OutputDebugStringA("=== OnFilterChanged END ===\n");
 }
 
 
-bool DayZLauncher::PassesAllFilters(const ServerInfo& server) const {
+FilterCriteria DayZLauncher::GetFilterCriteria() const {
+    FilterCriteria criteria;
+    criteria.tab = currentTab;
+    criteria.flags = filterFlags;
+    criteria.query = searchQuery;
 
-    if (!searchFilter.empty()) {
-        std::string serverName = server.name;
-        std::string serverMap = server.map;
-        std::string serverIP = server.ip;
-
-        std::transform(serverName.begin(), serverName.end(), serverName.begin(), ::tolower);
-        std::transform(serverMap.begin(), serverMap.end(), serverMap.begin(), ::tolower);
-        std::transform(serverIP.begin(), serverIP.end(), serverIP.begin(), ::tolower);
+    if (!mapFilter.empty()) criteria.query.AddMatch(FILTER_FIELD_MAP, mapFilter);
+    if (!versionFilter.empty()) criteria.query.AddMatch(FILTER_FIELD_VERSION, versionFilter);
+    if (minPlayersFilter > 0) criteria.query.AddComparison(FILTER_FIELD_PLAYERS, FILTER_CMP_GE, minPlayersFilter);
+    if (maxPingFilter > 0) criteria.query.AddComparison(FILTER_FIELD_PING, FILTER_CMP_LE, maxPingFilter);
+    criteria.query.Compile();
+    return criteria;
+}
 
-        bool found = (serverName.find(searchFilter) != std::string::npos) ||
-            (serverMap.find(searchFilter) != std::string::npos) ||
-            (serverIP.find(searchFilter) != std::string::npos);
+void DayZLauncher::SyncPlayedFlags() {
+    PlayedSnapshotRef played = favoritesManager->GetPlayedSnapshot();
+    if (played->version == playedVersion) return;
 
-        if (!found) {
-            return false;
+    for (auto it = servers.begin(); it != servers.end(); ++it) {
+        bool hasPlayed = played->HasPlayed(it->ip, it->port);
+        if (it->isPlayed != hasPlayed) {
+            it->isPlayed = hasPlayed;
+            servers.Update(it.GetId());
         }
     }
+    playedVersion = played->version;
+}
 
-   
-    if (!mapFilter.empty()) {
-        std::string serverMap = server.map;
-        std::transform(serverMap.begin(), serverMap.end(), serverMap.begin(), ::tolower);
 
-        if (serverMap.find("chernarus") != std::string::npos) {
-            OutputDebugStringA(("Testing map filter: server='" + serverMap + "' vs filter='" + mapFilter + "'\n").c_str());
-        }
+void DayZLauncher::ApplyFiltersAndUpdate() {
+    if (!hServerList || !IsWindow(hServerList)) return;
 
-        if (serverMap != mapFilter) {
-            return false;
-        }
+    OutputDebugStringA("=== ApplyFiltersAndUpdate START ===\n");
+
+    if (currentTab != TAB_FAVORITES) {
+        RequestFilterPass(false);
+        return;
     }
 
-    if (!versionFilter.empty()) {
-        if (server.version.find(versionFilter) == std::string::npos) {
-            return false;
-        }
+    ListView_DeleteAllItems(hServerList);
+    listModel.Reset();
+    shownSnapshot.reset();
+
+    if (!favoritesManager) {
+        UpdateStatusBar("No favorites manager");
+        return;
     }
 
+    const auto& favorites = favoritesManager->GetFavorites();
+    int favCount = 0;
 
-    if (filterFlags & FILTER_SHOW_FAVORITES && !server.isFavorite) return false;
-    if (filterFlags & FILTER_HIDE_PASSWORD && server.isPassworded) return false;
-    if (filterFlags & FILTER_ONLINE_ONLY && server.ping == -1) return false;
-    if (filterFlags & FILTER_NOT_FULL && server.players >= server.maxPlayers && server.maxPlayers > 0) return false;
-    if (filterFlags & FILTER_SHOW_MODDED && server.mods.empty()) return false;
+    for (const auto& favorite : favorites) {
+   
+        LVITEM lvi = {};
+        lvi.mask = LVIF_TEXT;
+        lvi.iItem = favCount;
+        lvi.iSubItem = 0;
 
-    if (filterFlags & FILTER_SHOW_PLAYED) {
-        bool hasPlayed = false;
-        if (favoritesManager) {
-            const auto& history = favoritesManager->GetRecentServers();
-            for (const auto& hist : history) {
-                if (hist.ip == server.ip && hist.port == server.port && hist.connectionCount > 0) {
-                    hasPlayed = true;
-                    break;
-                }
-            }
+        std::wstring serverName = StringToWString(favorite.name);
+        lvi.pszText = const_cast<LPWSTR>(serverName.c_str());
+        int itemIndex = ListView_InsertItem(hServerList, &lvi);
+
+        if (itemIndex != -1) {
+            SetListViewItemText(itemIndex, 1, L"Unknown");
+            SetListViewItemText(itemIndex, 2, L"0/0");
+            SetListViewItemText(itemIndex, 3, L"N/A");
+            std::string address = favorite.ip + ":" + std::to_string(favorite.port);
+            SetListViewItemText(itemIndex, 4, StringToWString(address));
+            SetListViewItemText(itemIndex, 5, L"Unknown");
+            favCount++;
         }
-        if (!hasPlayed) return false;
     }
 
-    return true;
+    UpdateStatusBar("Showing " + std::to_string(favCount) + " favorites");
 }
 
 
-void DayZLauncher::ApplyFiltersAndUpdate() {
-    if (!hServerList || !IsWindow(hServerList)) return;
+bool DayZLauncher::UpdateServerRows(const ServerSnapshot& snapshot, const std::vector<ListRow>& next) {
+    if (ListView_GetItemCount(hServerList) != static_cast<int>(listModel.size())) {
+        ListView_DeleteAllItems(hServerList);
+        listModel.Reset();
+    }
 
-    OutputDebugStringA("=== ApplyFiltersAndUpdate START ===\n");
-    ListView_DeleteAllItems(hServerList);
+    int selected = ListView_GetNextItem(hServerList, -1, LVNI_SELECTED);
+    ServerId selectedId = selected >= 0 ? listModel.GetId(static_cast<size_t>(selected)) : ServerId();
 
-    std::lock_guard<std::mutex> lock(serverMutex);
+    std::vector<ListChange> changes;
+    listModel.Diff(next, changes);
 
-  
-    if (currentTab == TAB_FAVORITES) {
-        if (!favoritesManager) {
-            UpdateStatusBar("No favorites manager");
-            return;
+    bool applied = true;
+    SendMessage(hServerList, WM_SETREDRAW, FALSE, 0);
+    for (const ListChange& change : changes) {
+        int position = static_cast<int>(change.position);
+        if (change.type == LIST_CHANGE_REMOVE) {
+            ListView_DeleteItem(hServerList, position);
+            continue;
         }
 
-        const auto& favorites = favoritesManager->GetFavorites();
-        int favCount = 0;
-
-        for (const auto& favorite : favorites) {
-   
-            LVITEM lvi = {};
-            lvi.mask = LVIF_TEXT;
-            lvi.iItem = favCount;
-            lvi.iSubItem = 0;
-
-            std::wstring serverName = StringToWString(favorite.name);
-            lvi.pszText = const_cast<LPWSTR>(serverName.c_str());
-            int itemIndex = ListView_InsertItem(hServerList, &lvi);
-
-            if (itemIndex != -1) {
-                SetListViewItemText(itemIndex, 1, L"Unknown");
-                SetListViewItemText(itemIndex, 2, L"0/0");
-                SetListViewItemText(itemIndex, 3, L"N/A");
-                std::string address = favorite.ip + ":" + std::to_string(favorite.port);
-                SetListViewItemText(itemIndex, 4, StringToWString(address));
-                SetListViewItemText(itemIndex, 5, L"Unknown");
-                favCount++;
+        const ServerInfo* record = snapshot.Get(change.id);
+        if (!record) {
+            applied = false;
+            break;
+        }
+        if (change.type == LIST_CHANGE_INSERT) {
+            if (!InsertServerRow(position, *record)) {
+                applied = false;
+                break;
             }
         }
+        else {
+            SetListViewItemText(position, 0, StringToWString(record->name));
+            SetServerRowDetails(position, *record);
+        }
+    }
 
-        UpdateStatusBar("Showing " + std::to_string(favCount) + " favorites");
-        return;
+    size_t selectedPosition = listModel.Find(selectedId);
+    if (applied && selectedPosition != LISTVIEWMODEL_NO_POSITION) {
+        ListView_SetItemState(hServerList, static_cast<int>(selectedPosition), LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
     }
 
+    SendMessage(hServerList, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hServerList, NULL, TRUE);
+    return applied;
+}
 
-    if (servers.empty()) {
-        UpdateStatusBar("No servers loaded - click 'Refresh Servers' to load servers");
+bool DayZLauncher::InsertServerRow(int position, const ServerInfo& server) {
+    LVITEM lvi = {};
+    lvi.mask = LVIF_TEXT;
+    lvi.iItem = position;
+    lvi.iSubItem = 0;
+
+    std::wstring serverName = StringToWString(server.name);
+    lvi.pszText = const_cast<LPWSTR>(serverName.c_str());
+    int listItemIndex = ListView_InsertItem(hServerList, &lvi);
+    if (listItemIndex == -1) return false;
+
+    SetServerRowDetails(listItemIndex, server);
+    return true;
+}
+
+void DayZLauncher::SetServerRowDetails(int listItemIndex, const ServerInfo& server) {
+    SetListViewItemText(listItemIndex, 1, StringToWString(server.map));
+    std::wstring playerText = std::to_wstring(server.players) + L"/" + std::to_wstring(server.maxPlayers);
+    SetListViewItemText(listItemIndex, 2, playerText);
+    std::wstring pingText = (server.ping == -1) ? L"N/A" : std::to_wstring(server.ping) + L"ms";
+    SetListViewItemText(listItemIndex, 3, pingText);
+    std::string address = server.ip + ":" + std::to_string(server.port);
+    SetListViewItemText(listItemIndex, 4, StringToWString(address));
+    SetListViewItemText(listItemIndex, 5, StringToWString(server.version));
+}
+
+
+void DayZLauncher::RequestFilterPass(bool debounce) {
+    if (currentTab == TAB_FAVORITES) {
+        ApplyFiltersAndUpdate();
         return;
     }
 
-    int filteredCount = 0;
-    int totalCount = static_cast<int>(servers.size());
-    int testedCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(serverMutex);
+        SyncPlayedFlags();
+    }
 
-    OutputDebugStringA(("Starting to filter " + std::to_string(totalCount) + " servers\n").c_str());
+    FilterJob job;
+    job.criteria = GetFilterCriteria();
+    job.sortKeys = sortKeys;
+    filterWorker.Submit(job, debounce);
+}
 
-    for (const auto& server : servers) {
-        testedCount++;
 
+void DayZLauncher::OnFilterResultReady(uint64_t generation) {
+    FilterResult result;
+    if (!filterWorker.TakeResult(generation, result)) return;
+    if (currentTab == TAB_FAVORITES || !hServerList || !IsWindow(hServerList)) return;
 
-        if (currentTab == TAB_OFFICIAL && !server.isOfficial) continue;
-        if (currentTab == TAB_COMMUNITY && server.isOfficial) continue;
-        if (currentTab == TAB_LAN && !IsLANAddress(server.ip)) continue;
+    DebugLogFormat("Filter pass: %s, tested %d servers", result.stats.incremental ? "incremental" :
+        (result.stats.cached ? "cached" : (result.stats.narrowed ? "narrowed" : "full")), static_cast<int>(result.stats.tested));
 
-   
-        if (PassesAllFilters(server)) {
-            LVITEM lvi = {};
-            lvi.mask = LVIF_TEXT;
-            lvi.iItem = filteredCount;
-            lvi.iSubItem = 0;
-
-            std::wstring serverName = StringToWString(server.name);
-            lvi.pszText = const_cast<LPWSTR>(serverName.c_str());
-            int listItemIndex = ListView_InsertItem(hServerList, &lvi);
-
-            if (listItemIndex != -1) {
-                SetListViewItemText(listItemIndex, 1, StringToWString(server.map));
-                std::wstring playerText = std::to_wstring(server.players) + L"/" + std::to_wstring(server.maxPlayers);
-                SetListViewItemText(listItemIndex, 2, playerText);
-                std::wstring pingText = (server.ping == -1) ? L"N/A" : std::to_wstring(server.ping) + L"ms";
-                SetListViewItemText(listItemIndex, 3, pingText);
-                std::string address = server.ip + ":" + std::to_string(server.port);
-                SetListViewItemText(listItemIndex, 4, StringToWString(address));
-                SetListViewItemText(listItemIndex, 5, StringToWString(server.version));
-                filteredCount++;
-            }
+    const ServerSnapshot& snapshot = *result.snapshot;
+    shownSnapshot = result.snapshot;
 
- 
-            if (filteredCount <= 5) {
-                OutputDebugStringA(("PASSED FILTER: " + server.name + " (map: " + server.map + ")\n").c_str());
-            }
-        }
-        else if (testedCount <= 5) {
-            OutputDebugStringA(("FAILED FILTER: " + server.name + " (map: " + server.map + ")\n").c_str());
+    if (snapshot.empty()) {
+        ListView_DeleteAllItems(hServerList);
+        listModel.Reset();
+        UpdateStatusBar("No servers loaded - click 'Refresh Servers' to load servers");
+        return;
+    }
+
+    std::vector<ListRow> next;
+    next.reserve(result.rows.size());
+    for (ServerId id : result.rows) {
+        uint64_t stamp = snapshot.GetStamp(id);
+        if (stamp) {
+            next.push_back({ id, stamp });
         }
     }
 
+    if (!UpdateServerRows(snapshot, next)) {
+        OutputDebugStringA("List diff failed, rebuilding server list\n");
+        ListView_DeleteAllItems(hServerList);
+        listModel.Reset();
+        UpdateServerRows(snapshot, next);
+    }
+
+    const ListDiffStats& diff = listModel.GetLastStats();
+    DebugLogFormat("List diff: %d inserted, %d removed, %d moved, %d updated, %d unchanged",
+        static_cast<int>(diff.inserted), static_cast<int>(diff.removed), static_cast<int>(diff.moved),
+        static_cast<int>(diff.updated), static_cast<int>(diff.unchanged));
+
+    int filteredCount = static_cast<int>(listModel.size());
+    int totalCount = static_cast<int>(snapshot.size());
+
+    UpdateFacetDropdowns(result);
+
     std::string statusMsg = "Showing " + std::to_string(filteredCount) + " of " + std::to_string(totalCount) + " servers";
     UpdateStatusBar(statusMsg);
 
     OutputDebugStringA(("FINAL RESULT: " + std::to_string(filteredCount) + " servers pass filters\n").c_str());
-    OutputDebugStringA("=== ApplyFiltersAndUpdate END ===\n");
+    OutputDebugStringA("=== OnFilterResultReady END ===\n");
 }
 
 
@@ -3789,26 +3728,103 @@ void DayZLauncher::ApplyFiltersAndUpdate() {
 
 
 void DayZLauncher::RefreshSingleServer(const std::string& ip, int port) {
-    if (IsServerRefreshNeeded(ip, port)) {
-        std::thread([this, ip, port]() {
-            A2SInfoResponse response;
-            if (queryManager->QueryServerInfo(ip, port, response)) {
-                std::lock_guard<std::mutex> lock(serverMutex);
-                for (auto& server : servers) {
-                    if (server.ip == ip && server.port == port) {
-                        server.name = response.name;
-                        server.players = response.players;
-                        server.maxPlayers = response.maxPlayers;
-                        server.ping = queryManager->PingServer(ip, port);
-                        server.lastUpdated = time(nullptr);
-                        PostMessage(hWnd, WM_REFRESH_PARTIAL, 0, 0);
-                        break;
-                    }
+    if (!IsServerRefreshNeeded(ip, port)) return;
+
+    RefreshServerAsync(ip, port).Detach();
+}
+
+QueryTask<> DayZLauncher::RefreshServerAsync(std::string ip, int port) {
+    QueryResult<A2SInfoResponse> info = co_await queryEngine->QueryInfo(ip, port);
+
+    if (info.ok) {
+        ModSetRef mods;
+        QueryResult<A2SRulesResponse> rules = co_await queryEngine->QueryRules(ip, port);
+        bool hasMods = rules.ok && ExtractModsFromRules(rules.response, mods);
+
+        if (!hasMods) {
+            mods = co_await queryEngine->Offload(*threadPool, [this, ip, port]() {
+                ModSetRef found;
+                QueryDZSAServerMods(ip, port, found);
+                return found;
+                });
+            hasMods = mods != nullptr;
+        }
+
+        threadPool->Post([this, ip, port, info, mods, hasMods]() {
+            std::lock_guard<std::mutex> lock(serverMutex);
+            ServerId id = servers.FindId(ip, port);
+            ServerInfo* server = servers.Get(id);
+            if (server) {
+                server->name = info.response.name;
+                server->players = info.response.players;
+                server->maxPlayers = info.response.maxPlayers;
+                server->ping = info.latencyMs;
+                server->lastUpdated = time(nullptr);
+                if (hasMods) {
+                    server->mods = mods;
                 }
+                servers.Update(id);
+                PostMessage(hWnd, WM_REFRESH_PARTIAL, 0, 0);
             }
-            MarkServerRefreshed(ip, port);
-            }).detach();
+            });
     }
+
+    MarkServerRefreshed(ip, port);
+}
+
+QueryTask<> DayZLauncher::ScanServerAsync(std::string ip, int port, ScanQueryWindow& window, BoundedQueue<ServerInfo>& enrich) {
+    DebugLogFormat("Querying server: %s:%d", ip.c_str(), port);
+
+    QueryResult<A2SInfoResponse> result = co_await queryEngine->QueryInfo(ip, port, SCAN_QUERY_RETRIES);
+    A2SInfoResponse& response = result.response;
+    bool queued = false;
+
+    if (!result.ok) {
+        DebugLogFormat("Server did not respond: %s:%d", ip.c_str(), port);
+    }
+    else {
+        DebugLogFormat("Server responded: %s", response.name.c_str());
+
+        std::string& cleanName = response.name;
+        cleanName.erase(std::remove(cleanName.begin(), cleanName.end(), '\0'), cleanName.end());
+
+        for (char& c : cleanName) {
+            if (c < 32 || c > 126) {
+                c = ' ';
+            }
+        }
+
+        cleanName.erase(0, cleanName.find_first_not_of(" \t\r\n"));
+        cleanName.erase(cleanName.find_last_not_of(" \t\r\n") + 1);
+
+        if (cleanName.empty() || cleanName.length() > 200 ||
+            response.maxPlayers > 200 || response.maxPlayers < 1) {
+            OutputDebugStringA("Skipping server with invalid data\n");
+        }
+        else {
+            ServerInfo info;
+            info.name = std::move(cleanName);
+            info.map = response.map.empty() ? "Unknown" : response.map;
+            info.ip = ip;
+            info.port = port;
+            info.players = response.players;
+            info.maxPlayers = response.maxPlayers;
+            info.version = response.version.empty() ? "1.27" : response.version;
+            info.hasVAC = (response.vac == 1);
+            info.isPassworded = (response.visibility == 1);
+            info.isFirstPerson = ServerUtils::IsFirstPersonServer(info.name, response.keywords);
+            info.folder = response.folder;
+            info.ping = result.latencyMs;
+
+            queued = enrich.TryPush(info);
+        }
+    }
+
+    if (!queued) {
+        window.slots.release();
+    }
+    window.processed++;
+    window.active--;
 }
 
 
@@ -3817,8 +3833,11 @@ void DayZLauncher::ResetFilters() {
 
 
     searchFilter.clear();
+    searchQuery.Clear();
     mapFilter.clear();
     versionFilter.clear();
+    minPlayersFilter = 0;
+    maxPingFilter = 0;
     filterFlags = 0;
 
    
@@ -3826,6 +3845,12 @@ void DayZLauncher::ResetFilters() {
         SetWindowText(hFilterSearch, L"");
         OutputDebugStringA("Cleared search box\n");
     }
+    if (hMinPlayersEdit && IsWindow(hMinPlayersEdit)) {
+        SetWindowText(hMinPlayersEdit, L"");
+    }
+    if (hMaxPingEdit && IsWindow(hMaxPingEdit)) {
+        SetWindowText(hMaxPingEdit, L"");
+    }
 
   
     if (hFilterMap && IsWindow(hFilterMap)) {
@@ -3917,23 +3942,23 @@ std::wstring DayZLauncher::GetDayZInstallPathW() {
 }
 
 void DayZLauncher::DebugServerDetection() {
-    std::lock_guard<std::mutex> lock(serverMutex);
+    ServerSnapshotRef snapshot = servers.GetSnapshot();
 
     int officialCount = 0;
     int communityCount = 0;
 
-    for (const auto& server : servers) {
+    snapshot->ForEach([&](const ServerInfo& server) {
         if (server.isOfficial) {
             officialCount++;
         }
         else {
             communityCount++;
         }
-    }
+    });
 
     std::string debugMsg = "Server counts - Official: " + std::to_string(officialCount) +
         ", Community: " + std::to_string(communityCount) +
-        ", Total: " + std::to_string(servers.size());
+        ", Total: " + std::to_string(snapshot->size());
 
     OutputDebugStringA((debugMsg + "\n").c_str());
     UpdateStatusBar(debugMsg);
@@ -3965,6 +3990,7 @@ void DayZLauncher::SaveConfiguration() {
 void DayZLauncher::SortByColumn(int column) {
     currentSortColumn = column;
     sortAscending = !sortAscending;
+    ServerSorter::Promote(sortKeys, SortSpec{ column, sortAscending });
     PopulateServerList();
 }
 
@@ -4024,6 +4050,7 @@ LRESULT CALLBACK DayZLauncher::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, L
     switch (uMsg) {
     case WM_CREATE:
         g_launcher->hWnd = hwnd;
+        g_launcher->filterWorker.Start(hwnd, WM_FILTER_READY);
         g_launcher->CreateControls();
         g_launcher->favoritesManager->LoadFavorites();
         PostMessage(hwnd, WM_USER + 100, 0, 0);
@@ -4043,19 +4070,16 @@ LRESULT CALLBACK DayZLauncher::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, L
         g_launcher->UpdateStatusBar("FORCE RELOAD: Settings loaded!");
         return 0;
 
-    case WM_USER + 200:
-        if (lParam) {
-            std::string statusText = reinterpret_cast<const char*>(lParam);
-            g_launcher->UpdateStatusBar(statusText);
-        }
-        return 0;
-
     case WM_SIZE:
         g_launcher->ResizeControls();
         return 0;
 
     case WM_REFRESH_PARTIAL:
-        g_launcher->PopulateServerList();
+        g_launcher->RequestFilterPass(true);
+        return 0;
+
+    case WM_FILTER_READY:
+        g_launcher->OnFilterResultReady(static_cast<uint64_t>(wParam));
         return 0;
 
     case WM_COMMAND: {
@@ -4080,16 +4104,18 @@ LRESULT CALLBACK DayZLauncher::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, L
 
         case ID_SERVER_REFRESH:
         {
-            ServerInfo* selectedServer = g_launcher->GetSelectedServer();
+            ServerRecordRef selectedServer = g_launcher->GetSelectedServer();
             if (selectedServer) {
                 g_launcher->RefreshSingleServer(selectedServer->ip, selectedServer->port);
             }
         }
         break;
         case IDC_FILTER_SEARCH:
+        case IDC_MIN_PLAYERS_EDIT:
+        case IDC_MAX_PING_EDIT:
             if (notificationCode == EN_CHANGE) {
                 OutputDebugStringA("Search text changed - applying filters\n");
-                g_launcher->OnFilterChanged();
+                g_launcher->OnFilterChanged(true);
             }
             break;
 
@@ -4220,6 +4246,9 @@ case IDC_FILTER_NOTFULL:
             ShowWindow(hwnd, SW_MINIMIZE);
             OutputDebugStringA("Application minimized after successful DayZ launch\n");
         }
+        else if (wParam == IDT_SCAN_DRAIN) {
+            g_launcher->DrainScanEvents();
+        }
         return 0;
 
     case WM_NOTIFY: {
@@ -4252,17 +4281,6 @@ case IDC_FILTER_NOTFULL:
         return 0;
     }
 
-    case WM_UPDATE_PROGRESS:
-        g_launcher->UpdateProgressBar(static_cast<int>(wParam));
-        return 0;
-
-    case WM_REFRESH_COMPLETE:
-        g_launcher->isRefreshing = false;
-        g_launcher->PopulateServerList();
-        g_launcher->UpdateStatusBar("Ready");
-        g_launcher->UpdateProgressBar(0);
-        return 0;
-
     case WM_TRAYICON:
         g_launcher->HandleTrayMessage(wParam, lParam);
         return 0;
@@ -4395,7 +4413,7 @@ case IDC_FILTER_NOTFULL:
 
         case VK_DELETE:
             if (GetFocus() == g_launcher->hServerList) {
-                ServerInfo* selectedServer = g_launcher->GetSelectedServer();
+                ServerRecordRef selectedServer = g_launcher->GetSelectedServer();
                 if (selectedServer && selectedServer->isFavorite) {
                     g_launcher->ToggleFavorite();
                 }
@@ -22,9 +22,19 @@
 #include <functional>
 #include <queue>
 #include <condition_variable>
+#include <semaphore>
 #include <shlobj.h>
 #include <commdlg.h>
 #include "ServerQuery.h"
+#include "ServerStore.h"
+#include "ServerFilter.h"
+#include "FilterWorker.h"
+#include "ServerListViewModel.h"
+#include "SpscQueue.h"
+#include "ThreadPool.h"
+#include "CancellationToken.h"
+#include "ScanPipeline.h"
+#include "QueryEngine.h"
 #include "FavoritesManager.h"
 #include "resource.h"
 #include <regex>
@@ -40,32 +50,6 @@
 
 
 
-class ThreadPool {
-private:
-    std::vector<std::thread> workers;
-    bool stop;
-
-public:
-    ThreadPool(size_t threads = 4) : stop(false) {
-    
-    }
-
-    ~ThreadPool() {
-        stop = true;
-        for (auto& worker : workers) {
-            if (worker.joinable()) {
-                worker.join();
-            }
-        }
-    }
-
-
-    template<class F>
-    void enqueue(F&& f) {
-     
-    }
-};
-
 class ServerCache {
 private:
     std::unordered_map<std::string, ServerInfo> cache;
@@ -116,6 +100,41 @@ public:
     void SetString(const std::string& key, const std::string& value);
 };
 
+#define SCAN_EVENT_QUEUE_SIZE   1024
+#define SCAN_QUERY_RETRIES      1
+#define SCAN_ENRICH_WORKERS     1
+#define SCAN_RULES_WORKERS      2
+#define SCAN_LAUNCH_INTERVAL_US 250
+#define SCAN_REPORT_INTERVAL_MS 250
+
+enum ScanEventType {
+    SCAN_EVENT_STATUS,
+    SCAN_EVENT_PROGRESS,
+    SCAN_EVENT_SERVERS_ADDED,
+    SCAN_EVENT_COMPLETE
+};
+
+struct ScanEvent {
+    ScanEventType type = SCAN_EVENT_STATUS;
+    int value = 0;
+    std::string text;
+};
+
+struct ScanQueryContext {
+    ServerQueryManager query;
+    bool ready = query.Initialize();
+
+    void Interrupt() { query.Interrupt(); }
+};
+
+struct ScanQueryWindow {
+    explicit ScanQueryWindow(ptrdiff_t limit) : slots(limit) {}
+
+    std::counting_semaphore<> slots;
+    std::atomic<int> active{ 0 };
+    std::atomic<int> processed{ 0 };
+};
+
 class DayZLauncher {
 private:
 
@@ -157,6 +176,8 @@ private:
     HWND hFilterMapLabel;
     HWND hFilterVersionLabel;
     HWND hFilterOptionsLabel;
+    HWND hMinPlayersLabel;
+    HWND hMaxPingLabel;
 
 
     HWND hProfileNameEdit;
@@ -183,8 +204,13 @@ private:
     HWND hColorButtonLabel;
 
 
-    std::vector<ServerInfo> servers;
+    ServerStore servers{ false };
+    ServerListViewModel listModel;
+    ServerSnapshotRef shownSnapshot;
+    SpscQueue<ScanEvent, SCAN_EVENT_QUEUE_SIZE> scanEvents;
+    uint64_t playedVersion = 0;
     std::mutex serverMutex;
+    FilterWorker filterWorker{ servers, serverMutex };
     int currentTab = 0;
     std::atomic<bool> isRefreshing{ false };
     std::string filterText;
@@ -192,15 +218,20 @@ private:
 
     DWORD filterFlags = 0;
     std::string searchFilter;
-    std::string mapFilter;
-    std::string versionFilter;
+    InternedString mapFilter;
+    InternedString versionFilter;
+    FilterQuery searchQuery;
+    int minPlayersFilter = 0;
+    int maxPingFilter = 0;
+    std::vector<FacetCounts::Entry> shownMapFacets;
+    std::vector<FacetCounts::Entry> shownVersionFacets;
 
     std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastServerRefresh;
     std::mutex refreshMutex;
 
 
     std::vector<std::string> ExtractWorkshopIDs(const std::string& modString);
-    bool QueryDZSAServerMods(const std::string& ip, int port, std::vector<std::string>& mods);
+    bool QueryDZSAServerMods(const std::string& ip, int port, ModSetRef& mods);
 
 
     bool QueryMultipleAPIs(std::vector<std::pair<std::string, int>>& servers);
@@ -214,14 +245,16 @@ private:
     std::unique_ptr<ConfigManager> configManager;
     std::unique_ptr<ServerCache> serverCache;
     std::unique_ptr<ThreadPool> threadPool;
+    std::unique_ptr<QueryEngine> queryEngine;
 
 
     std::thread refreshThread;
-    bool shouldStopRefresh = false;
+    CancellationTokenRef scanCancel;
 
  
     int currentSortColumn = SORT_PING;
     bool sortAscending = true;
+    std::vector<SortSpec> sortKeys;
 
   
     WNDPROC originalListViewProc = nullptr;
@@ -240,7 +273,7 @@ private:
     std::vector<std::string> QueryBattlEyeInfo(const std::string& ip, int port);
 
     bool DetectOfficialServer(const std::string& name, const std::string& folder);
-    bool ExtractModsFromRules(const A2SRulesResponse& rules, std::vector<std::string>& mods);
+    bool ExtractModsFromRules(const A2SRulesResponse& rules, ModSetRef& mods);
     bool ServerNameIndicatesMods(const std::string& name);
     std::string GetCountryFromIP(const std::string& ip);
 
@@ -248,7 +281,7 @@ public:
     DayZLauncher();
     ~DayZLauncher();
 
-    bool LaunchViaSteam(ServerInfo* server);
+    bool LaunchViaSteam(const ServerInfo* server);
 
     void ForceSaveDayZPath();
     void EmergencyManualSave();
@@ -262,9 +295,15 @@ public:
     void CreateFilterPanel();
     void UpdateFilteredServerList();
     void CreateMapDropdown(int x, int y);
+    void UpdateFacetDropdowns(const FilterResult& result);
+    void PopulateFacetDropdown(HWND combo, const wchar_t* allLabel, const std::vector<FacetCounts::Entry>& entries,
+        std::vector<FacetCounts::Entry>& shown, bool capitalize);
+    StringId GetSelectedFacet(HWND combo) const;
     void ResetFilters();
     void RefreshSingleServer(const std::string& ip, int port);
-    void OnFilterChanged();
+    QueryTask<> RefreshServerAsync(std::string ip, int port);
+    QueryTask<> ScanServerAsync(std::string ip, int port, ScanQueryWindow& window, BoundedQueue<ServerInfo>& enrich);
+    void OnFilterChanged(bool debounce = false);
 
   
     void SetupServerListColumns();
@@ -314,8 +353,9 @@ public:
     void SortByColumn(int column);
     void UpdateStatusBar(const std::string& text);
     void UpdateProgressBar(int progress);
-    ServerInfo* GetSelectedServer();
-    std::vector<ServerInfo> GetFilteredServers() const;
+    ServerRecordRef GetSelectedServer();
+    ServerRecordRef GetServerAtRow(int row);
+    void SetServerFavorite(const ServerInfo& server, bool favorite);
     void LoadConfiguration();
     void SaveConfiguration();
     std::wstring GetDayZInstallPathW();
@@ -332,13 +372,20 @@ public:
     void OnContextMenu(WPARAM wParam, LPARAM lParam);
     void OnUpdateProgress(int progress);
     void OnRefreshComplete();
+    void PostScanEvent(ScanEventType type, int value = 0, const std::string& text = std::string());
+    void DrainScanEvents();
     void ApplyFiltersAndUpdate();
-    bool PassesAllFilters(const ServerInfo& server) const;
+    void RequestFilterPass(bool debounce);
+    void OnFilterResultReady(uint64_t generation);
+    bool UpdateServerRows(const ServerSnapshot& snapshot, const std::vector<ListRow>& next);
+    bool InsertServerRow(int position, const ServerInfo& server);
+    void SetServerRowDetails(int listItemIndex, const ServerInfo& server);
+    FilterCriteria GetFilterCriteria() const;
+    void SyncPlayedFlags();
 
 private:
 
     HFONT hSmallFont;
-    bool PassesFilters(const ServerInfo& server) const;
     void CreateFilterCheckbox(HWND& control, const wchar_t* text, int id, int x, int y, int width = 200);
     void CreateFilterEditBox(HWND& control, int id, int x, int y, int width = 200, int height = 25);
     void CreateFilterLabel(HWND& control, const wchar_t* text, int x, int y, int width = 200);
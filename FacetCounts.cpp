@@ -0,0 +1,89 @@
+#include "FacetCounts.h"
+#include "ServerQuery.h"
+#include <algorithm>
+
+
+static const int PLAYER_BUCKET_LIMITS[FACET_PLAYER_BUCKETS - 1] = { 1, 10, 30, 50 };
+static const int PING_BUCKET_LIMITS[FACET_PING_BUCKETS - 2] = { 50, 100, 200 };
+
+static const char* PLAYER_BUCKET_LABELS[FACET_PLAYER_BUCKETS] = { "0", "1-9", "10-29", "30-49", "50+" };
+static const char* PING_BUCKET_LABELS[FACET_PING_BUCKETS] = { "<50ms", "50-99ms", "100-199ms", "200ms+", "Offline" };
+
+
+FacetKey FacetKey::FromServer(const ServerInfo& server) {
+    FacetKey key;
+    key.map = server.map.lowerId();
+    key.version = server.version.lowerId();
+    key.playerBucket = static_cast<uint8_t>(FacetCounts::GetPlayerBucket(server.players));
+    key.pingBucket = static_cast<uint8_t>(FacetCounts::GetPingBucket(server.ping));
+    return key;
+}
+
+
+void FacetCounts::Add(const FacetKey& key) {
+    if (key.map != STRINGPOOL_EMPTY_ID) maps[key.map]++;
+    if (key.version != STRINGPOOL_EMPTY_ID) versions[key.version]++;
+    playerBuckets[key.playerBucket]++;
+    pingBuckets[key.pingBucket]++;
+}
+
+void FacetCounts::Remove(const FacetKey& key) {
+    Decrement(maps, key.map);
+    Decrement(versions, key.version);
+    playerBuckets[key.playerBucket]--;
+    pingBuckets[key.pingBucket]--;
+}
+
+void FacetCounts::Decrement(std::unordered_map<StringId, uint32_t>& counts, StringId id) {
+    auto it = counts.find(id);
+    if (it != counts.end() && --it->second == 0) {
+        counts.erase(it);
+    }
+}
+
+void FacetCounts::Clear() {
+    maps.clear();
+    versions.clear();
+    std::fill(std::begin(playerBuckets), std::end(playerBuckets), 0);
+    std::fill(std::begin(pingBuckets), std::end(pingBuckets), 0);
+}
+
+uint32_t FacetCounts::GetMapCount(StringId map) const {
+    auto it = maps.find(map);
+    return it != maps.end() ? it->second : 0;
+}
+
+uint32_t FacetCounts::GetVersionCount(StringId version) const {
+    auto it = versions.find(version);
+    return it != versions.end() ? it->second : 0;
+}
+
+std::vector<FacetCounts::Entry> FacetCounts::SortByCount(const std::unordered_map<StringId, uint32_t>& counts) {
+    std::vector<Entry> entries(counts.begin(), counts.end());
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.second != b.second) return a.second > b.second;
+        return StringPool::Instance().Get(a.first) < StringPool::Instance().Get(b.first);
+    });
+    return entries;
+}
+
+int FacetCounts::GetPlayerBucket(int players) {
+    int bucket = 0;
+    while (bucket < FACET_PLAYER_BUCKETS - 1 && players >= PLAYER_BUCKET_LIMITS[bucket]) bucket++;
+    return bucket;
+}
+
+int FacetCounts::GetPingBucket(int ping) {
+    if (ping < 0) return FACET_PING_BUCKETS - 1;
+    int bucket = 0;
+    while (bucket < FACET_PING_BUCKETS - 2 && ping >= PING_BUCKET_LIMITS[bucket]) bucket++;
+    return bucket;
+}
+
+const char* FacetCounts::GetPlayerBucketLabel(int bucket) {
+    return PLAYER_BUCKET_LABELS[bucket];
+}
+
+const char* FacetCounts::GetPingBucketLabel(int bucket) {
+    return PING_BUCKET_LABELS[bucket];
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include "StringPool.h"
+
+struct ServerInfo;
+
+
+#define FACET_PLAYER_BUCKETS        5
+#define FACET_PING_BUCKETS          5
+
+
+struct FacetKey {
+    StringId map = STRINGPOOL_EMPTY_ID;
+    StringId version = STRINGPOOL_EMPTY_ID;
+    uint8_t playerBucket = 0;
+    uint8_t pingBucket = 0;
+
+    static FacetKey FromServer(const ServerInfo& server);
+};
+
+
+class FacetCounts {
+public:
+    typedef std::pair<StringId, uint32_t> Entry;
+
+    void Add(const FacetKey& key);
+    void Remove(const FacetKey& key);
+    void Clear();
+
+    uint32_t GetMapCount(StringId map) const;
+    uint32_t GetVersionCount(StringId version) const;
+    uint32_t GetPlayerBucketCount(int bucket) const { return playerBuckets[bucket]; }
+    uint32_t GetPingBucketCount(int bucket) const { return pingBuckets[bucket]; }
+
+    std::vector<Entry> GetMaps() const { return SortByCount(maps); }
+    std::vector<Entry> GetVersions() const { return SortByCount(versions); }
+
+    static int GetPlayerBucket(int players);
+    static int GetPingBucket(int ping);
+    static const char* GetPlayerBucketLabel(int bucket);
+    static const char* GetPingBucketLabel(int bucket);
+
+private:
+    static std::vector<Entry> SortByCount(const std::unordered_map<StringId, uint32_t>& counts);
+    static void Decrement(std::unordered_map<StringId, uint32_t>& counts, StringId id);
+
+    std::unordered_map<StringId, uint32_t> maps;
+    std::unordered_map<StringId, uint32_t> versions;
+    uint32_t playerBuckets[FACET_PLAYER_BUCKETS] = {};
+    uint32_t pingBuckets[FACET_PING_BUCKETS] = {};
+};
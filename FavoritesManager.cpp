@@ -134,8 +134,13 @@ ServerHistory ServerHistory::fromJson(const std::string& json) {
 }
 
 
+int PlayedSnapshot::GetConnectionCount(const std::string& ip, int port) const {
+    auto it = connectionCounts.find(ServerUtils::PackAddress(ip, port));
+    return it != connectionCounts.end() ? it->second : 0;
+}
+
 FavoritesManager::FavoritesManager(const std::string& favFile, const std::string& histFile)
-    : favoritesFile(favFile), historyFile(histFile) {
+    : favoritesFile(favFile), historyFile(histFile), playedSnapshot(std::make_shared<PlayedSnapshot>()) {
   
 }
 
@@ -365,6 +370,8 @@ void FavoritesManager::LoadHistory() {
             }
         }
     }
+
+    PublishPlayedSnapshot();
 }
 
 void FavoritesManager::SaveHistory() {
@@ -416,6 +423,8 @@ void FavoritesManager::AddToHistory(const ServerInfo& server) {
             });
         recentServers.resize(MAX_HISTORY_ENTRIES);
     }
+
+    PublishPlayedSnapshot();
 }
 
 void FavoritesManager::RecordConnection(const std::string& ip, int port, const std::string& serverName) {
@@ -442,6 +451,8 @@ void FavoritesManager::RecordConnection(const std::string& ip, int port, const s
 
         recentServers.push_back(history);
     }
+
+    PublishPlayedSnapshot();
 }
 
 void FavoritesManager::RecordPlayTime(const std::string& ip, int port, std::chrono::seconds playTime) {
@@ -457,13 +468,23 @@ void FavoritesManager::RecordPlayTime(const std::string& ip, int port, std::chro
     }
 }
 
-const std::vector<ServerHistory>& FavoritesManager::GetRecentServers() const {
+std::vector<ServerHistory> FavoritesManager::GetRecentServers() const {
+    std::lock_guard<std::mutex> lock(historyMutex);
     return recentServers;
 }
 
+PlayedSnapshotRef FavoritesManager::GetPlayedSnapshot() const {
+    return playedSnapshot.load();
+}
+
+bool FavoritesManager::HasPlayed(const std::string& ip, int port) const {
+    return GetPlayedSnapshot()->HasPlayed(ip, port);
+}
+
 void FavoritesManager::ClearHistory() {
     std::lock_guard<std::mutex> lock(historyMutex);
     recentServers.clear();
+    PublishPlayedSnapshot();
 }
 
 size_t FavoritesManager::GetFavoriteCount() const {
@@ -529,6 +550,7 @@ void FavoritesManager::CleanupOldHistory(std::chrono::hours maxAge) {
         });
 
     recentServers.erase(it, recentServers.end());
+    PublishPlayedSnapshot();
 }
 
 void FavoritesManager::OptimizeStorage() {
@@ -564,6 +586,7 @@ void FavoritesManager::OptimizeStorage() {
         });
 
     recentServers.erase(histEnd, recentServers.end());
+    PublishPlayedSnapshot();
 }
 
 void FavoritesManager::RebuildFavoriteAddressSet() {
@@ -573,6 +596,21 @@ void FavoritesManager::RebuildFavoriteAddressSet() {
     }
 }
 
+void FavoritesManager::PublishPlayedSnapshot() {
+    auto snapshot = std::make_shared<PlayedSnapshot>();
+    snapshot->version = playedSnapshot.load()->version + 1;
+    snapshot->connectionCounts.reserve(recentServers.size());
+
+    for (const auto& history : recentServers) {
+        uint64_t address = ServerUtils::PackAddress(history.ip, history.port);
+        if (address && history.connectionCount > 0) {
+            snapshot->connectionCounts[address] += history.connectionCount;
+        }
+    }
+
+    playedSnapshot.store(PlayedSnapshotRef(std::move(snapshot)));
+}
+
 void FavoritesManager::TrimHistory() {
     if (recentServers.size() > MAX_HISTORY_ENTRIES) {
    
@@ -7,6 +7,10 @@
 #include <fstream>
 #include <chrono>
 #include <functional>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
 
 struct ServerInfo;
 
@@ -57,6 +61,16 @@ struct ServerHistory {
     static ServerHistory fromJson(const std::string& json);
 };
 
+struct PlayedSnapshot {
+    uint64_t version = 0;
+    std::unordered_map<uint64_t, int> connectionCounts;
+
+    int GetConnectionCount(const std::string& ip, int port) const;
+    bool HasPlayed(const std::string& ip, int port) const { return GetConnectionCount(ip, port) > 0; }
+};
+
+typedef std::shared_ptr<const PlayedSnapshot> PlayedSnapshotRef;
+
 class FavoritesManager {
 private:
     std::string favoritesFile;
@@ -66,6 +80,7 @@ private:
     std::unordered_set<std::string> favoriteAddresses; 
     mutable std::mutex favoritesMutex;
     mutable std::mutex historyMutex;
+    std::atomic<PlayedSnapshotRef> playedSnapshot;
 
     static const size_t MAX_HISTORY_ENTRIES = 100;
 
@@ -99,7 +114,9 @@ public:
     void AddToHistory(const ServerInfo& server);
     void RecordConnection(const std::string& ip, int port, const std::string& serverName);
     void RecordPlayTime(const std::string& ip, int port, std::chrono::seconds playTime);
-    const std::vector<ServerHistory>& GetRecentServers() const;
+    std::vector<ServerHistory> GetRecentServers() const;
+    PlayedSnapshotRef GetPlayedSnapshot() const;
+    bool HasPlayed(const std::string& ip, int port) const;
     void ClearHistory();
 
  
@@ -119,6 +136,7 @@ private:
 
     void RebuildFavoriteAddressSet();
     void TrimHistory();
+    void PublishPlayedSnapshot();
     std::string AddressToString(const std::string& ip, int port) const;
     bool CreateBackup(const std::string& filename) const;
 
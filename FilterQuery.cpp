@@ -0,0 +1,391 @@
+#include "FilterQuery.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+
+struct FilterKeyword {
+    const char* name;
+    FilterField field;
+};
+
+static const FilterKeyword FILTER_KEYWORDS[] = {
+    { "players",    FILTER_FIELD_PLAYERS },
+    { "maxplayers", FILTER_FIELD_MAX_PLAYERS },
+    { "slots",      FILTER_FIELD_MAX_PLAYERS },
+    { "free",       FILTER_FIELD_FREE_SLOTS },
+    { "ping",       FILTER_FIELD_PING },
+    { "map",        FILTER_FIELD_MAP },
+    { "version",    FILTER_FIELD_VERSION },
+    { "mod",        FILTER_FIELD_MOD },
+    { "name",       FILTER_FIELD_NAME },
+};
+
+struct FilterAttributeName {
+    const char* name;
+    int attribute;
+    bool inverted;
+};
+
+static const FilterAttributeName FILTER_ATTRIBUTE_NAMES[] = {
+    { "pw",         SERVER_ATTR_PASSWORDED,   false },
+    { "password",   SERVER_ATTR_PASSWORDED,   false },
+    { "full",       SERVER_ATTR_FULL,         false },
+    { "modded",     SERVER_ATTR_MODDED,       false },
+    { "official",   SERVER_ATTR_OFFICIAL,     false },
+    { "community",  SERVER_ATTR_OFFICIAL,     true },
+    { "lan",        SERVER_ATTR_LAN,          false },
+    { "fav",        SERVER_ATTR_FAVORITE,     false },
+    { "favorite",   SERVER_ATTR_FAVORITE,     false },
+    { "played",     SERVER_ATTR_PLAYED,       false },
+    { "1pp",        SERVER_ATTR_FIRST_PERSON, false },
+    { "fpp",        SERVER_ATTR_FIRST_PERSON, false },
+    { "3pp",        SERVER_ATTR_THIRD_PERSON, false },
+    { "tpp",        SERVER_ATTR_THIRD_PERSON, false },
+    { "online",     SERVER_ATTR_ONLINE,       false },
+    { "offline",    SERVER_ATTR_ONLINE,       true },
+};
+
+
+static FilterCompare InvertCompare(FilterCompare compare) {
+    switch (compare) {
+    case FILTER_CMP_EQ: return FILTER_CMP_NE;
+    case FILTER_CMP_NE: return FILTER_CMP_EQ;
+    case FILTER_CMP_LT: return FILTER_CMP_GE;
+    case FILTER_CMP_LE: return FILTER_CMP_GT;
+    case FILTER_CMP_GT: return FILTER_CMP_LE;
+    default: return FILTER_CMP_LT;
+    }
+}
+
+static bool ParseInteger(std::string_view text, int64_t& value) {
+    if (text.empty() || text.size() > 19) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+static bool IsLowerBound(FilterCompare compare) {
+    return compare == FILTER_CMP_GT || compare == FILTER_CMP_GE;
+}
+
+static bool IsUpperBound(FilterCompare compare) {
+    return compare == FILTER_CMP_LT || compare == FILTER_CMP_LE;
+}
+
+
+bool FilterInstruction::Implies(const FilterInstruction& weaker) const {
+    if (*this == weaker) return true;
+    if (field != weaker.field) return false;
+
+    if (field == FILTER_FIELD_NAME) {
+        return compare == FILTER_CMP_EQ && weaker.compare == FILTER_CMP_EQ && text.find(weaker.text) != std::string::npos;
+    }
+    if (field == FILTER_FIELD_MAP || field == FILTER_FIELD_VERSION || field == FILTER_FIELD_MOD) {
+        return false;
+    }
+
+    if (IsLowerBound(compare) && IsLowerBound(weaker.compare)) {
+        int64_t bound = compare == FILTER_CMP_GT ? operand + 1 : operand;
+        int64_t weakerBound = weaker.compare == FILTER_CMP_GT ? weaker.operand + 1 : weaker.operand;
+        return bound >= weakerBound;
+    }
+    if (IsUpperBound(compare) && IsUpperBound(weaker.compare)) {
+        int64_t bound = compare == FILTER_CMP_LT ? operand - 1 : operand;
+        int64_t weakerBound = weaker.compare == FILTER_CMP_LT ? weaker.operand - 1 : weaker.operand;
+        return bound <= weakerBound;
+    }
+    return false;
+}
+
+
+void FilterQuery::Clear() {
+    program.clear();
+    patterns.clear();
+    requiredAttributes = 0;
+    excludedAttributes = 0;
+    searchText.clear();
+    error.clear();
+}
+
+void FilterQuery::SetSearchText(const std::string& text) {
+    Clear();
+    searchText = text;
+}
+
+bool FilterQuery::Fail(const std::string& message) {
+    Clear();
+    error = message;
+    return false;
+}
+
+bool FilterQuery::Parse(const std::string& query) {
+    Clear();
+
+    size_t pos = 0;
+    int terms = 0;
+    while (pos < query.size()) {
+        while (pos < query.size() && std::isspace(static_cast<unsigned char>(query[pos]))) pos++;
+        if (pos >= query.size()) break;
+
+        std::string term;
+        bool literal = query[pos] == '"';
+        bool quoted = false;
+        while (pos < query.size() && (quoted || !std::isspace(static_cast<unsigned char>(query[pos])))) {
+            if (query[pos] == '"') quoted = !quoted;
+            else term += query[pos];
+            pos++;
+        }
+
+        if (++terms > FILTERQUERY_MAX_TERMS) {
+            return Fail("Too many filter terms (max " + std::to_string(FILTERQUERY_MAX_TERMS) + ")");
+        }
+        if (literal) {
+            if (!searchText.empty()) searchText += ' ';
+            searchText += term;
+        }
+        else if (!ParseTerm(term)) {
+            return false;
+        }
+    }
+
+    Compile();
+    return true;
+}
+
+bool FilterQuery::ParseTerm(std::string_view term) {
+    std::string_view body = term;
+    bool negate = false;
+    bool prefixed = false;
+    if (body.size() > 1 && (body[0] == '!' || body[0] == '-' || body[0] == '+')) {
+        negate = body[0] != '+';
+        prefixed = true;
+        body.remove_prefix(1);
+    }
+
+    size_t keyLength = 0;
+    while (keyLength < body.size() && std::isalpha(static_cast<unsigned char>(body[keyLength]))) keyLength++;
+    std::string_view key = body.substr(0, keyLength);
+    std::string_view rest = body.substr(keyLength);
+
+    FilterCompare compare = FILTER_CMP_EQ;
+    size_t operatorLength = 0;
+    if (rest.compare(0, 2, ">=") == 0) { compare = FILTER_CMP_GE; operatorLength = 2; }
+    else if (rest.compare(0, 2, "<=") == 0) { compare = FILTER_CMP_LE; operatorLength = 2; }
+    else if (rest.compare(0, 2, "!=") == 0) { compare = FILTER_CMP_NE; operatorLength = 2; }
+    else if (!rest.empty() && rest[0] == '>') { compare = FILTER_CMP_GT; operatorLength = 1; }
+    else if (!rest.empty() && rest[0] == '<') { compare = FILTER_CMP_LT; operatorLength = 1; }
+    else if (!rest.empty() && (rest[0] == '=' || rest[0] == ':')) { compare = FILTER_CMP_EQ; operatorLength = 1; }
+
+    if (operatorLength > 0 && (key == "is" || key == "has")) {
+        if (compare != FILTER_CMP_EQ && compare != FILTER_CMP_NE) {
+            return Fail("'" + std::string(key) + "' only supports ':'");
+        }
+        std::string_view name = rest.substr(operatorLength);
+        if (!ParseAttribute(name, negate != (compare == FILTER_CMP_NE))) {
+            return Fail("Unknown attribute '" + std::string(name) + "'");
+        }
+        return true;
+    }
+
+    const FilterKeyword* keyword = nullptr;
+    if (operatorLength > 0) {
+        for (const FilterKeyword& candidate : FILTER_KEYWORDS) {
+            if (key == candidate.name) {
+                keyword = &candidate;
+                break;
+            }
+        }
+    }
+
+    if (!keyword) {
+        if (prefixed && operatorLength == 0 && ParseAttribute(body, negate)) {
+            return true;
+        }
+        if (!searchText.empty()) searchText += ' ';
+        searchText.append(term.data(), term.size());
+        return true;
+    }
+
+    std::string_view value = rest.substr(operatorLength);
+    if (value.empty()) {
+        return Fail("Missing value for '" + std::string(key) + "'");
+    }
+    if (negate) {
+        compare = InvertCompare(compare);
+    }
+
+    FilterInstruction instruction;
+    instruction.field = keyword->field;
+    instruction.compare = compare;
+
+    switch (keyword->field) {
+    case FILTER_FIELD_PLAYERS:
+    case FILTER_FIELD_MAX_PLAYERS:
+    case FILTER_FIELD_FREE_SLOTS:
+    case FILTER_FIELD_PING:
+        if (!ParseInteger(value, instruction.operand)) {
+            return Fail("'" + std::string(key) + "' expects a number");
+        }
+        break;
+
+    default:
+        if (compare != FILTER_CMP_EQ && compare != FILTER_CMP_NE) {
+            return Fail("'" + std::string(key) + "' only supports ':' and '!='");
+        }
+        if (keyword->field == FILTER_FIELD_MOD) {
+            if (!ParseInteger(value, instruction.operand)) {
+                return Fail("'mod' expects a Workshop id");
+            }
+        }
+        else if (keyword->field == FILTER_FIELD_NAME) {
+            instruction.text = std::string(value);
+            TextSearch::ToLowerAscii(instruction.text);
+            instruction.operand = static_cast<int64_t>(patterns.size());
+            patterns.emplace_back(instruction.text);
+        }
+        else {
+            std::string lowered(value);
+            TextSearch::ToLowerAscii(lowered);
+            StringId id = StringPool::Instance().Intern(lowered);
+            instruction.operand = id != STRINGPOOL_EMPTY_ID ? static_cast<int64_t>(id) : -1;
+            instruction.text = lowered;
+        }
+        break;
+    }
+
+    program.push_back(std::move(instruction));
+    return true;
+}
+
+bool FilterQuery::ParseAttribute(std::string_view name, bool negate) {
+    for (const FilterAttributeName& candidate : FILTER_ATTRIBUTE_NAMES) {
+        if (name == candidate.name) {
+            uint32_t bit = 1u << candidate.attribute;
+            if (negate == candidate.inverted) requiredAttributes |= bit;
+            else excludedAttributes |= bit;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FilterQuery::AddComparison(FilterField field, FilterCompare compare, int64_t operand) {
+    FilterInstruction instruction;
+    instruction.field = field;
+    instruction.compare = compare;
+    instruction.operand = operand;
+    program.push_back(instruction);
+}
+
+void FilterQuery::AddMatch(FilterField field, const InternedString& value) {
+    FilterInstruction instruction;
+    instruction.field = field;
+    instruction.compare = FILTER_CMP_EQ;
+    instruction.operand = static_cast<int64_t>(value.lowerId());
+    instruction.text = value.lower();
+    program.push_back(instruction);
+}
+
+int FilterQuery::GetRank(const FilterInstruction& instruction) {
+    switch (instruction.field) {
+    case FILTER_FIELD_MAP:
+    case FILTER_FIELD_VERSION:
+        return 0;
+    case FILTER_FIELD_MOD:
+        return 1;
+    case FILTER_FIELD_NAME:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+void FilterQuery::Compile() {
+    std::stable_sort(program.begin(), program.end(),
+        [](const FilterInstruction& a, const FilterInstruction& b) {
+            return GetRank(a) < GetRank(b);
+        });
+    program.erase(std::unique(program.begin(), program.end()), program.end());
+}
+
+bool FilterQuery::CompareNumber(int64_t value, FilterCompare compare, int64_t operand) {
+    switch (compare) {
+    case FILTER_CMP_EQ: return value == operand;
+    case FILTER_CMP_NE: return value != operand;
+    case FILTER_CMP_LT: return value < operand;
+    case FILTER_CMP_LE: return value <= operand;
+    case FILTER_CMP_GT: return value > operand;
+    default: return value >= operand;
+    }
+}
+
+bool FilterQuery::Evaluate(const ServerInfo& server) const {
+    for (const FilterInstruction& instruction : program) {
+        bool wanted = instruction.compare != FILTER_CMP_NE;
+        bool pass;
+
+        switch (instruction.field) {
+        case FILTER_FIELD_PLAYERS:
+            pass = CompareNumber(server.players, instruction.compare, instruction.operand);
+            break;
+        case FILTER_FIELD_MAX_PLAYERS:
+            pass = CompareNumber(server.maxPlayers, instruction.compare, instruction.operand);
+            break;
+        case FILTER_FIELD_FREE_SLOTS:
+            pass = CompareNumber(static_cast<int64_t>(server.maxPlayers) - server.players, instruction.compare, instruction.operand);
+            break;
+        case FILTER_FIELD_PING:
+            pass = server.isOnline() && CompareNumber(server.ping, instruction.compare, instruction.operand);
+            break;
+        case FILTER_FIELD_MAP:
+            pass = (server.map.lowerId() == instruction.operand) == wanted;
+            break;
+        case FILTER_FIELD_VERSION:
+            pass = (server.version.lowerId() == instruction.operand) == wanted;
+            break;
+        case FILTER_FIELD_MOD:
+            pass = (server.hasMods() && server.mods->Contains(static_cast<WorkshopId>(instruction.operand))) == wanted;
+            break;
+        default:
+            pass = patterns[static_cast<size_t>(instruction.operand)].Matches(server.name) == wanted;
+            break;
+        }
+
+        if (!pass) return false;
+    }
+    return true;
+}
+
+bool FilterQuery::HasField(FilterField field) const {
+    return std::any_of(program.begin(), program.end(),
+        [field](const FilterInstruction& instruction) { return instruction.field == field; });
+}
+
+FilterQuery FilterQuery::WithoutField(FilterField field) const {
+    FilterQuery relaxed = *this;
+    relaxed.program.erase(std::remove_if(relaxed.program.begin(), relaxed.program.end(),
+        [field](const FilterInstruction& instruction) { return instruction.field == field; }), relaxed.program.end());
+    return relaxed;
+}
+
+bool FilterQuery::operator==(const FilterQuery& other) const {
+    return requiredAttributes == other.requiredAttributes && excludedAttributes == other.excludedAttributes &&
+        searchText == other.searchText && program == other.program;
+}
+
+bool FilterQuery::IsNarrowerThan(const FilterQuery& previous) const {
+    if (previous.requiredAttributes & ~requiredAttributes) return false;
+    if (previous.excludedAttributes & ~excludedAttributes) return false;
+    if (!previous.searchText.empty() && searchText.find(previous.searchText) == std::string::npos) return false;
+
+    for (const FilterInstruction& weaker : previous.program) {
+        bool implied = std::any_of(program.begin(), program.end(),
+            [&weaker](const FilterInstruction& instruction) { return instruction.Implies(weaker); });
+        if (!implied) return false;
+    }
+    return true;
+}
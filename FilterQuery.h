@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include "ServerStore.h"
+#include "TextSearch.h"
+
+
+#define FILTERQUERY_MAX_TERMS       32
+
+
+enum FilterField {
+    FILTER_FIELD_PLAYERS,
+    FILTER_FIELD_MAX_PLAYERS,
+    FILTER_FIELD_FREE_SLOTS,
+    FILTER_FIELD_PING,
+    FILTER_FIELD_MAP,
+    FILTER_FIELD_VERSION,
+    FILTER_FIELD_MOD,
+    FILTER_FIELD_NAME
+};
+
+enum FilterCompare {
+    FILTER_CMP_EQ,
+    FILTER_CMP_NE,
+    FILTER_CMP_LT,
+    FILTER_CMP_LE,
+    FILTER_CMP_GT,
+    FILTER_CMP_GE
+};
+
+
+struct FilterInstruction {
+    FilterField field = FILTER_FIELD_PLAYERS;
+    FilterCompare compare = FILTER_CMP_EQ;
+    int64_t operand = 0;
+    std::string text;
+
+    bool operator==(const FilterInstruction& other) const {
+        return field == other.field && compare == other.compare && operand == other.operand && text == other.text;
+    }
+
+    bool Implies(const FilterInstruction& weaker) const;
+};
+
+
+class FilterQuery {
+public:
+    bool Parse(const std::string& query);
+    void Clear();
+    void SetSearchText(const std::string& text);
+
+    void AddComparison(FilterField field, FilterCompare compare, int64_t operand);
+    void AddMatch(FilterField field, const InternedString& value);
+    void Compile();
+
+    bool Evaluate(const ServerInfo& server) const;
+
+    bool HasProgram() const { return !program.empty(); }
+    bool HasField(FilterField field) const;
+    FilterQuery WithoutField(FilterField field) const;
+    const std::vector<FilterInstruction>& GetProgram() const { return program; }
+    uint32_t GetRequiredAttributes() const { return requiredAttributes; }
+    uint32_t GetExcludedAttributes() const { return excludedAttributes; }
+    const std::string& GetSearchText() const { return searchText; }
+    const std::string& GetError() const { return error; }
+
+    bool operator==(const FilterQuery& other) const;
+    bool operator!=(const FilterQuery& other) const { return !(*this == other); }
+    bool IsNarrowerThan(const FilterQuery& previous) const;
+
+private:
+    bool ParseTerm(std::string_view term);
+    bool ParseAttribute(std::string_view name, bool negate);
+    bool Fail(const std::string& message);
+
+    static int GetRank(const FilterInstruction& instruction);
+    static bool CompareNumber(int64_t value, FilterCompare compare, int64_t operand);
+
+    std::vector<FilterInstruction> program;
+    std::vector<TextSearch> patterns;
+    uint32_t requiredAttributes = 0;
+    uint32_t excludedAttributes = 0;
+    std::string searchText;
+    std::string error;
+};
@@ -0,0 +1,154 @@
+#include "FilterWorker.h"
+#include <algorithm>
+
+
+FilterWorker::FilterWorker(ServerStore& store, std::mutex& storeMutex)
+    : store(store), storeMutex(storeMutex) {
+}
+
+FilterWorker::~FilterWorker() {
+    Stop();
+}
+
+void FilterWorker::Start(HWND window, UINT message) {
+    if (thread.joinable()) return;
+
+    notifyWindow = window;
+    notifyMessage = message;
+    stopping = false;
+    thread = std::thread(&FilterWorker::Run, this);
+}
+
+void FilterWorker::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+uint64_t FilterWorker::Submit(const FilterJob& job, bool debounce) {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        pendingJob = job;
+        generation = ++latestGeneration;
+        pendingGeneration = generation;
+        hasPending = true;
+        runAfter = std::chrono::steady_clock::now() + std::chrono::milliseconds(debounce ? FILTERWORKER_DEBOUNCE_MS : 0);
+    }
+    jobReady.notify_one();
+    return generation;
+}
+
+bool FilterWorker::TakeResult(uint64_t generation, FilterResult& result) {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    if (!hasReady || readyResult.generation != generation) return false;
+
+    result = std::move(readyResult);
+    hasReady = false;
+    return true;
+}
+
+void FilterWorker::Run() {
+    std::unique_lock<std::mutex> lock(jobMutex);
+    while (!stopping) {
+        if (!hasPending) {
+            jobReady.wait(lock);
+            continue;
+        }
+        if (std::chrono::steady_clock::now() < runAfter) {
+            jobReady.wait_until(lock, runAfter);
+            continue;
+        }
+
+        FilterJob job = std::move(pendingJob);
+        uint64_t generation = pendingGeneration;
+        hasPending = false;
+        lock.unlock();
+
+        FilterResult result;
+        bool finished = false;
+        try {
+            finished = Execute(job, generation, result);
+        }
+        catch (...) {
+            OutputDebugStringA("Exception in filter worker\n");
+        }
+
+        lock.lock();
+        if (finished && !IsStale(generation)) {
+            readyResult = std::move(result);
+            hasReady = true;
+            PostMessage(notifyWindow, notifyMessage, static_cast<WPARAM>(generation), 0);
+        }
+    }
+}
+
+bool FilterWorker::Execute(const FilterJob& job, uint64_t generation, FilterResult& result) {
+    bool complete;
+    {
+        std::lock_guard<std::mutex> storeLock(storeMutex);
+        if (IsStale(generation)) return false;
+
+        complete = store.TakeChanges(mirroredRevision, changedSlots);
+        mirroredRevision = store.GetRevision();
+        result.snapshot = store.Publish();
+    }
+
+    if (complete) {
+        mirror.Mirror(*result.snapshot, changedSlots);
+    }
+    else {
+        mirror.Mirror(*result.snapshot);
+    }
+
+    bool invalidate = invalidateRequested.exchange(false);
+    if (invalidate) {
+        engine.Invalidate();
+    }
+
+    complete = mirror.TakeChanges(orderedRevision, changedSlots);
+    bool incremental = !invalidate && complete && orderedValid && job.sortKeys == orderedKeys && ApplyChanges(job);
+
+    if (!incremental) {
+        std::vector<ServerId> rows = engine.Apply(mirror, job.criteria);
+        sorter.Sort(mirror, job.sortKeys, rows);
+        ordered.Assign(sorter.GetEntries());
+        orderedKeys = job.sortKeys;
+        orderedValid = true;
+    }
+
+    orderedRevision = mirror.GetRevision();
+    ordered.GetRows(result.rows);
+    result.mapFacets = engine.GetMapFacets();
+    result.versionFacets = engine.GetVersionFacets();
+    result.stats = engine.GetLastStats();
+    result.totalCount = result.snapshot->size();
+    result.generation = generation;
+    return true;
+}
+
+bool FilterWorker::ApplyChanges(const FilterJob& job) {
+    std::sort(changedSlots.begin(), changedSlots.end());
+    changedSlots.erase(std::unique(changedSlots.begin(), changedSlots.end()), changedSlots.end());
+
+    if (!engine.ApplyChanges(mirror, job.criteria, changedSlots, removedSlots, addedSlots)) return false;
+
+    sorter.SetOrder(mirror, job.sortKeys);
+    auto less = [this](const SortedRows::Entry& a, const SortedRows::Entry& b) { return sorter.Less(a, b); };
+
+    for (uint32_t slot : removedSlots) {
+        size_t position;
+        ordered.Erase(slot, position);
+    }
+
+    for (uint32_t slot : addedSlots) {
+        ordered.Insert(sorter.MakeEntry(mirror.GetSlotId(slot)), less);
+    }
+    return true;
+}
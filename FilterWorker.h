@@ -0,0 +1,86 @@
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "ServerStore.h"
+#include "ServerFilter.h"
+#include "ServerSort.h"
+#include "SortedRows.h"
+
+
+#define FILTERWORKER_DEBOUNCE_MS    150
+
+
+struct FilterJob {
+    FilterCriteria criteria;
+    std::vector<SortSpec> sortKeys;
+};
+
+
+struct FilterResult {
+    uint64_t generation = 0;
+    std::vector<ServerId> rows;
+    std::vector<FacetCounts::Entry> mapFacets;
+    std::vector<FacetCounts::Entry> versionFacets;
+    FilterStats stats;
+    size_t totalCount = 0;
+    ServerSnapshotRef snapshot;
+};
+
+
+class FilterWorker {
+public:
+    FilterWorker(ServerStore& store, std::mutex& storeMutex);
+    ~FilterWorker();
+
+    void Start(HWND notifyWindow, UINT notifyMessage);
+    void SetThreadPool(ThreadPool* pool) { sorter.SetThreadPool(pool); }
+    void Stop();
+
+    uint64_t Submit(const FilterJob& job, bool debounce);
+    bool TakeResult(uint64_t generation, FilterResult& result);
+    void Invalidate() { invalidateRequested = true; }
+
+private:
+    void Run();
+    bool Execute(const FilterJob& job, uint64_t generation, FilterResult& result);
+    bool ApplyChanges(const FilterJob& job);
+    bool IsStale(uint64_t generation) const { return generation != latestGeneration.load(); }
+
+    ServerStore& store;
+    std::mutex& storeMutex;
+    uint64_t mirroredRevision = 0;
+    ServerStore mirror;
+    FilterEngine engine;
+    ServerSorter sorter;
+    SortedRows ordered;
+    std::vector<SortSpec> orderedKeys;
+    uint64_t orderedRevision = 0;
+    bool orderedValid = false;
+    std::vector<uint32_t> changedSlots;
+    std::vector<uint32_t> removedSlots;
+    std::vector<uint32_t> addedSlots;
+
+    HWND notifyWindow = nullptr;
+    UINT notifyMessage = 0;
+
+    std::thread thread;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    FilterJob pendingJob;
+    uint64_t pendingGeneration = 0;
+    bool hasPending = false;
+    std::chrono::steady_clock::time_point runAfter;
+    FilterResult readyResult;
+    bool hasReady = false;
+    bool stopping = false;
+
+    std::atomic<uint64_t> latestGeneration{ 0 };
+    std::atomic<bool> invalidateRequested{ false };
+};
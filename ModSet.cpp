@@ -0,0 +1,181 @@
+#include "ModSet.h"
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MODSET_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+#ifdef MODSET_USE_SSE2
+static inline int MatchLanes(const WorkshopId* a, const WorkshopId* b) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    __m128i vbSwapped = _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2));
+
+    __m128i straight = _mm_cmpeq_epi32(va, vb);
+    __m128i crossed = _mm_cmpeq_epi32(va, vbSwapped);
+    straight = _mm_and_si128(straight, _mm_shuffle_epi32(straight, _MM_SHUFFLE(2, 3, 0, 1)));
+    crossed = _mm_and_si128(crossed, _mm_shuffle_epi32(crossed, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_movemask_pd(_mm_castsi128_pd(_mm_or_si128(straight, crossed)));
+}
+#endif
+
+
+template <typename OnMatch>
+static void IntersectSorted(const std::vector<WorkshopId>& left, const std::vector<WorkshopId>& right, OnMatch onMatch) {
+    const WorkshopId* a = left.data();
+    const WorkshopId* b = right.data();
+    size_t na = left.size();
+    size_t nb = right.size();
+    size_t i = 0;
+    size_t j = 0;
+
+#ifdef MODSET_USE_SSE2
+    while (i + 2 <= na && j + 2 <= nb) {
+        int lanes = MatchLanes(a + i, b + j);
+        if (lanes & 1) onMatch(a[i]);
+        if (lanes & 2) onMatch(a[i + 1]);
+
+        WorkshopId maxA = a[i + 1];
+        WorkshopId maxB = b[j + 1];
+        if (maxA <= maxB) i += 2;
+        if (maxB <= maxA) j += 2;
+    }
+#endif
+
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        }
+        else if (b[j] < a[i]) {
+            j++;
+        }
+        else {
+            onMatch(a[i]);
+            i++;
+            j++;
+        }
+    }
+}
+
+
+bool ModSet::Contains(WorkshopId id) const {
+    return std::binary_search(ids.begin(), ids.end(), id);
+}
+
+bool ModSet::IsSubsetOf(const ModSet& other) const {
+    if (this == &other || ids.empty()) return true;
+    if (ids.size() > other.ids.size()) return false;
+    if (ids.front() < other.ids.front() || ids.back() > other.ids.back()) return false;
+    return IntersectionSize(other) == ids.size();
+}
+
+size_t ModSet::IntersectionSize(const ModSet& other) const {
+    if (this == &other) return ids.size();
+
+    size_t count = 0;
+    IntersectSorted(ids, other.ids, [&count](WorkshopId) { count++; });
+    return count;
+}
+
+std::vector<WorkshopId> ModSet::Intersect(const ModSet& other) const {
+    if (this == &other) return ids;
+
+    std::vector<WorkshopId> result;
+    result.reserve((std::min)(ids.size(), other.ids.size()));
+    IntersectSorted(ids, other.ids, [&result](WorkshopId id) { result.push_back(id); });
+    return result;
+}
+
+std::string ModSet::ToLaunchArgument() const {
+    std::string result;
+    result.reserve(ids.size() * 12);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i > 0) result += ";";
+        result += "@" + std::to_string(ids[i]);
+    }
+    return result;
+}
+
+size_t ModSet::HashIds(const std::vector<WorkshopId>& ids) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (WorkshopId id : ids) {
+        hash ^= id;
+        hash *= 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    return static_cast<size_t>(hash ^ ids.size());
+}
+
+
+ModSetTable& ModSetTable::Instance() {
+    static ModSetTable table;
+    return table;
+}
+
+ModSetRef ModSetTable::Intern(std::vector<WorkshopId> ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    ids.erase(std::remove(ids.begin(), ids.end(), WorkshopId(0)), ids.end());
+
+    if (ids.empty()) return nullptr;
+
+    size_t hash = ModSet::HashIds(ids);
+
+    std::lock_guard<std::mutex> lock(tableMutex);
+
+    auto range = table.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        ModSetRef existing = it->second.lock();
+        if (existing && existing->ids == ids) {
+            return existing;
+        }
+    }
+
+    if (++insertsSincePurge >= 256) {
+        PurgeExpiredLocked();
+    }
+
+    ModSetRef created(new ModSet(std::move(ids), hash));
+    table.emplace(hash, created);
+    return created;
+}
+
+ModSetRef ModSetTable::FromWorkshopStrings(const std::vector<std::string>& mods) {
+    std::vector<WorkshopId> ids;
+    ids.reserve(mods.size());
+
+    for (const std::string& mod : mods) {
+        size_t start = (!mod.empty() && mod[0] == '@') ? 1 : 0;
+        size_t end = start;
+        while (end < mod.size() && mod[end] >= '0' && mod[end] <= '9') {
+            end++;
+        }
+        if (end > start && end - start <= 20) {
+            ids.push_back(std::strtoull(mod.c_str() + start, nullptr, 10));
+        }
+    }
+
+    return Intern(std::move(ids));
+}
+
+size_t ModSetTable::GetCount() {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    PurgeExpiredLocked();
+    return table.size();
+}
+
+void ModSetTable::PurgeExpiredLocked() {
+    for (auto it = table.begin(); it != table.end();) {
+        if (it->second.expired()) {
+            it = table.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    insertsSincePurge = 0;
+}
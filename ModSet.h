@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+
+typedef uint64_t WorkshopId;
+
+class ModSet;
+typedef std::shared_ptr<const ModSet> ModSetRef;
+
+
+class ModSet {
+public:
+    const std::vector<WorkshopId>& GetIds() const { return ids; }
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+    std::vector<WorkshopId>::const_iterator begin() const { return ids.begin(); }
+    std::vector<WorkshopId>::const_iterator end() const { return ids.end(); }
+    size_t GetHash() const { return hash; }
+
+    bool Contains(WorkshopId id) const;
+    bool IsSubsetOf(const ModSet& other) const;
+    size_t IntersectionSize(const ModSet& other) const;
+    std::vector<WorkshopId> Intersect(const ModSet& other) const;
+
+    std::string ToLaunchArgument() const;
+
+    static size_t HashIds(const std::vector<WorkshopId>& ids);
+    static bool Equals(const ModSetRef& a, const ModSetRef& b) { return a == b; }
+
+private:
+    friend class ModSetTable;
+    ModSet(std::vector<WorkshopId>&& sortedIds, size_t hash) : ids(std::move(sortedIds)), hash(hash) {}
+
+    std::vector<WorkshopId> ids;
+    size_t hash;
+};
+
+
+class ModSetTable {
+public:
+    static ModSetTable& Instance();
+
+    ModSetRef Intern(std::vector<WorkshopId> ids);
+    ModSetRef FromWorkshopStrings(const std::vector<std::string>& mods);
+
+    size_t GetCount();
+
+private:
+    ModSetTable() = default;
+    ModSetTable(const ModSetTable&) = delete;
+    ModSetTable& operator=(const ModSetTable&) = delete;
+
+    void PurgeExpiredLocked();
+
+    std::mutex tableMutex;
+    std::unordered_multimap<size_t, std::weak_ptr<const ModSet>> table;
+    size_t insertsSincePurge = 0;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+#else
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+typedef int SOCKET;
+typedef uint32_t DWORD;
+typedef uint16_t WORD;
+typedef int BOOL;
+typedef unsigned long u_long;
+
+#define INVALID_SOCKET      (-1)
+#define SOCKET_ERROR        (-1)
+#define WSAEWOULDBLOCK      EWOULDBLOCK
+#define WSAECONNRESET       ECONNREFUSED
+#define WSAEINTR            EINTR
+#define WSAETIMEDOUT        ETIMEDOUT
+#define FIONBIO             0
+#define INFINITE            0xFFFFFFFFu
+#define WAIT_OBJECT_0       0
+#define WAIT_TIMEOUT        258
+#define TRUE                1
+#define FALSE               0
+#define MAKEWORD(a, b)      static_cast<WORD>(((a) & 0xFF) | (((b) & 0xFF) << 8))
+
+struct WSADATA {
+    WORD wVersion;
+};
+
+inline int WSAStartup(WORD, WSADATA*) { return 0; }
+inline int WSACleanup() { return 0; }
+inline int WSAGetLastError() { return errno; }
+inline void WSASetLastError(int error) { errno = error; }
+inline int closesocket(SOCKET s) { return close(s); }
+
+inline int ioctlsocket(SOCKET s, long, u_long* nonBlocking) {
+    int flags = fcntl(s, F_GETFL);
+    return fcntl(s, F_SETFL, *nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+}
+
+inline void Sleep(DWORD milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds)); }
+inline void OutputDebugStringA(const char* text) {
+#ifndef NDEBUG
+    fputs(text, stderr);
+#else
+    (void)text;
+#endif
+}
+
+
+struct PlatformEvent {
+    std::mutex mutex;
+    std::condition_variable signalled;
+    bool set = false;
+};
+
+typedef PlatformEvent* HANDLE;
+
+inline HANDLE CreateEvent(void*, BOOL, BOOL initial, const char*) {
+    HANDLE event = new PlatformEvent();
+    event->set = initial != FALSE;
+    return event;
+}
+
+inline BOOL SetEvent(HANDLE event) {
+    {
+        std::lock_guard<std::mutex> lock(event->mutex);
+        event->set = true;
+    }
+    event->signalled.notify_all();
+    return TRUE;
+}
+
+inline DWORD WaitForSingleObject(HANDLE event, DWORD milliseconds) {
+    std::unique_lock<std::mutex> lock(event->mutex);
+    auto isSet = [event]() { return event->set; };
+    if (milliseconds == INFINITE) {
+        event->signalled.wait(lock, isSet);
+        return WAIT_OBJECT_0;
+    }
+    return event->signalled.wait_for(lock, std::chrono::milliseconds(milliseconds), isSet) ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+}
+
+inline BOOL CloseHandle(HANDLE event) {
+    delete event;
+    return TRUE;
+}
+
+#endif
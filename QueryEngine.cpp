@@ -0,0 +1,640 @@
+#include "QueryEngine.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+QueryEngine::ExchangeAwaiter::ExchangeAwaiter(QueryEngine& engine, const std::string& ip, int port, uint8_t type, int timeoutMs, int retries)
+    : engine(engine), address{}, type(type), timeoutMs(timeoutMs), retries(retries), cancel(CancellationToken::Current()) {
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    valid = inet_pton(AF_INET, ip.c_str(), &address.sin_addr) == 1 && GetReplyType(type) != 0;
+}
+
+bool QueryEngine::ExchangeAwaiter::Suspend(std::coroutine_handle<> handle) {
+    waiter = handle;
+    return engine.Submit(this);
+}
+
+
+std::string QueryEngineStats::Format() const {
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "Query engine: %d sent, %d joined in-flight, %d completed, %d timed out, %d retried, %d challenged, %d cancelled, %d unmatched; "
+        "requests peak %d/%d, backlog peak %d; datagrams peak %d/%d, %d dropped; "
+        "frames %d served from %d slabs (%d KB), %d on heap",
+        static_cast<int>(sent), static_cast<int>(joined), static_cast<int>(completed), static_cast<int>(timedOut), static_cast<int>(retried),
+        static_cast<int>(challenged), static_cast<int>(cancelled), static_cast<int>(unmatched),
+        static_cast<int>(requests.peak), static_cast<int>(requests.capacity), static_cast<int>(peakBacklog),
+        static_cast<int>(datagrams.peak), static_cast<int>(datagrams.capacity), static_cast<int>(datagrams.exhausted),
+        static_cast<int>(frames.allocations), static_cast<int>(frames.slabs), static_cast<int>(frames.slabBytes / 1024),
+        static_cast<int>(frames.oversized));
+    return buffer;
+}
+
+
+QueryEngine::QueryEngine() {}
+
+QueryEngine::~QueryEngine() {
+    Stop();
+}
+
+bool QueryEngine::Start(size_t maxInFlight) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return true;
+
+    this->maxInFlight = (std::max)(maxInFlight, size_t(1));
+
+    size_t bucketCount = 2;
+    bucketShift = 63;
+    while (bucketCount < this->maxInFlight * 2) {
+        bucketCount <<= 1;
+        bucketShift--;
+    }
+    buckets.assign(bucketCount, nullptr);
+    deadlines.reserve(this->maxInFlight);
+    ready.reserve(this->maxInFlight);
+    posted.reserve(this->maxInFlight);
+    requests.Reserve(this->maxInFlight);
+    datagrams.Reserve(this->maxInFlight * 2 + 1);
+
+    if (!transport.Initialize()) {
+        OutputDebugStringA("ERROR: Failed to open query engine socket!\n");
+        return false;
+    }
+    transport.SetSocketNonBlocking(transport.udpSocket, true);
+
+    int receiveBuffer = QUERYENGINE_RECEIVE_BUFFER;
+    setsockopt(transport.udpSocket, SOL_SOCKET, SO_RCVBUF, (char*)&receiveBuffer, sizeof(receiveBuffer));
+
+    try {
+        stopping = false;
+        running = true;
+        loopThread = std::thread(&QueryEngine::Run, this);
+    }
+    catch (...) {
+        running = false;
+        transport.Cleanup();
+        OutputDebugStringA("ERROR: Failed to start query engine thread!\n");
+        return false;
+    }
+    return true;
+}
+
+void QueryEngine::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running || stopping) return;
+        stopping = true;
+    }
+
+    transport.Interrupt();
+    if (loopThread.joinable()) loopThread.join();
+    transport.Cleanup();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+}
+
+bool QueryEngine::Submit(ExchangeAwaiter* awaiter) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running || stopping) return false;
+
+        awaiter->next = nullptr;
+        if (submittedTail) submittedTail->next = awaiter;
+        else submittedHead = awaiter;
+        submittedTail = awaiter;
+    }
+    transport.Interrupt();
+    return true;
+}
+
+bool QueryEngine::Post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running || stopping) return false;
+        posted.push_back(handle);
+    }
+    transport.Interrupt();
+    return true;
+}
+
+QueryEngineStats QueryEngine::GetStats() const {
+    QueryEngineStats stats;
+    stats.sent = sentCount.load();
+    stats.joined = joinedCount.load();
+    stats.completed = completedCount.load();
+    stats.timedOut = timedOutCount.load();
+    stats.retried = retriedCount.load();
+    stats.challenged = challengedCount.load();
+    stats.cancelled = cancelledCount.load();
+    stats.unmatched = unmatchedCount.load();
+    stats.backlog = backlogSize.load();
+    stats.peakBacklog = peakBacklog.load();
+    stats.requests = requests.GetStats();
+    stats.datagrams = datagrams.GetStats();
+    stats.frames = FramePool::Instance().GetStats();
+    return stats;
+}
+
+
+void QueryEngine::Run() {
+    ScanArena arena;
+    ScanArena::Scope arenaScope(arena);
+
+    std::vector<std::coroutine_handle<>> resumes;
+    resumes.reserve(maxInFlight);
+    receiving = datagrams.Acquire();
+
+    while (true) {
+        ExchangeAwaiter* incoming;
+        bool stop;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            incoming = submittedHead;
+            submittedHead = submittedTail = nullptr;
+            resumes.swap(posted);
+            stop = stopping;
+        }
+
+        while (incoming) {
+            ExchangeAwaiter* awaiter = incoming;
+            incoming = incoming->next;
+            awaiter->next = nullptr;
+            if (backlogTail) backlogTail->next = awaiter;
+            else backlogHead = awaiter;
+            backlogTail = awaiter;
+
+            size_t waiting = ++backlogSize;
+            size_t peak = peakBacklog.load();
+            while (waiting > peak && !peakBacklog.compare_exchange_weak(peak, waiting)) {
+            }
+        }
+
+        if (stop) {
+            while (!deadlines.empty()) {
+                Finish(deadlines.front(), false);
+            }
+        }
+        else {
+            CancelRequests();
+            ExpireRequests();
+        }
+
+        while (backlogHead) {
+            ExchangeAwaiter* awaiter = backlogHead;
+            bool cancelled = awaiter->cancel && awaiter->cancel->IsCancelled();
+            Request* flight = stop || cancelled ? nullptr : FindFlight(awaiter);
+            if (!stop && !cancelled && !flight && deadlines.size() >= maxInFlight) break;
+
+            backlogHead = awaiter->next;
+            if (!backlogHead) backlogTail = nullptr;
+            awaiter->next = nullptr;
+            backlogSize--;
+
+            if (stop || cancelled) {
+                if (cancelled) cancelledCount++;
+                Fail(awaiter);
+            }
+            else if (flight) {
+                Join(flight, awaiter);
+            }
+            else {
+                Begin(requests.Acquire(), awaiter);
+            }
+        }
+
+        resumes.insert(resumes.end(), ready.begin(), ready.end());
+        ready.clear();
+        for (std::coroutine_handle<> handle : resumes) {
+            handle.resume();
+        }
+        resumes.clear();
+
+        if (stop) break;
+
+        if (!receiving) {
+            receiving = datagrams.Acquire();
+        }
+
+        long long waitMicros = QUERYENGINE_IDLE_WAIT_MS * 1000LL;
+        if (!deadlines.empty()) {
+            long long untilDeadline = std::chrono::duration_cast<std::chrono::microseconds>(
+                deadlines.front()->deadline - std::chrono::steady_clock::now()).count();
+            waitMicros = (std::max)(0LL, (std::min)(waitMicros, untilDeadline));
+        }
+
+        fd_set readable;
+        FD_ZERO(&readable);
+        SOCKET highest = 0;
+        if (receiving) {
+            FD_SET(transport.udpSocket, &readable);
+            highest = transport.udpSocket;
+        }
+        if (transport.wakeSocket != INVALID_SOCKET) {
+            FD_SET(transport.wakeSocket, &readable);
+            highest = (std::max)(highest, transport.wakeSocket);
+        }
+
+        timeval timeout;
+        timeout.tv_sec = static_cast<long>(waitMicros / 1000000);
+        timeout.tv_usec = static_cast<long>(waitMicros % 1000000);
+
+        if (select(static_cast<int>(highest + 1), &readable, nullptr, nullptr, &timeout) == SOCKET_ERROR) {
+            Sleep(10);
+            continue;
+        }
+
+        if (transport.wakeSocket != INVALID_SOCKET && FD_ISSET(transport.wakeSocket, &readable)) {
+            char signal[16];
+            while (recv(transport.wakeSocket, signal, sizeof(signal), 0) > 0) {
+            }
+        }
+
+        if (receiving && FD_ISSET(transport.udpSocket, &readable)) {
+            while (receiving) {
+                sockaddr_in fromAddr;
+                socklen_t fromLen = sizeof(fromAddr);
+                int bytes = recvfrom(transport.udpSocket, (char*)receiving->data, static_cast<int>(sizeof(receiving->data)), 0,
+                    (sockaddr*)&fromAddr, &fromLen);
+                if (bytes == SOCKET_ERROR) {
+                    if (WSAGetLastError() == WSAECONNRESET) continue;
+                    break;
+                }
+                Dispatch(bytes, fromAddr);
+            }
+        }
+    }
+
+    datagrams.Release(receiving);
+    receiving = nullptr;
+}
+
+void QueryEngine::Begin(Request* request, ExchangeAwaiter* awaiter) {
+    request->awaiter = awaiter;
+    request->key = GetAddressKey(awaiter->address);
+    request->attempts = 1;
+    request->sent = std::chrono::steady_clock::now();
+    request->deadline = request->sent + std::chrono::milliseconds(awaiter->timeoutMs);
+
+    Request*& bucket = GetBucket(request->key);
+    request->nextInBucket = bucket;
+    bucket = request;
+    PushDeadline(request);
+
+    Send(request);
+}
+
+QueryEngine::Request* QueryEngine::FindFlight(const ExchangeAwaiter* awaiter) {
+    uint64_t key = GetAddressKey(awaiter->address);
+    for (Request* request = GetBucket(key); request; request = request->nextInBucket) {
+        if (request->key == key && request->awaiter->type == awaiter->type) return request;
+    }
+    return nullptr;
+}
+
+void QueryEngine::Join(Request* request, ExchangeAwaiter* awaiter) {
+    awaiter->next = request->joined;
+    request->joined = awaiter;
+    joinedCount++;
+}
+
+void QueryEngine::Send(Request* request) {
+    size_t size = BuildRequest(request->awaiter->type, request->challenged ? request->challenge : nullptr, packet);
+
+    if (sendto(transport.udpSocket, (const char*)packet, static_cast<int>(size), 0,
+        (sockaddr*)&request->awaiter->address, sizeof(request->awaiter->address)) == SOCKET_ERROR) {
+        Finish(request, false);
+        return;
+    }
+    sentCount++;
+}
+
+void QueryEngine::Dispatch(int bytes, const sockaddr_in& from) {
+    const uint8_t* data = receiving->data;
+    if (bytes > QUERYENGINE_SPLIT_HEADER && data[0] == 0xFE && data[1] == 0xFF && data[2] == 0xFF && data[3] == 0xFF) {
+        DispatchSplit(bytes, GetAddressKey(from));
+        return;
+    }
+    if (bytes < 5 || data[0] != 0xFF || data[1] != 0xFF || data[2] != 0xFF || data[3] != 0xFF) {
+        unmatchedCount++;
+        return;
+    }
+
+    uint8_t kind = data[4];
+    uint64_t key = GetAddressKey(from);
+    Request* match = nullptr;
+    for (Request* request = GetBucket(key); request; request = request->nextInBucket) {
+        if (request->key != key) continue;
+
+        bool wanted = kind == 0x41 ? !request->challenged : GetReplyType(request->awaiter->type) == kind;
+        if (wanted && (!match || request->sent < match->sent)) {
+            match = request;
+        }
+    }
+
+    if (!match) {
+        unmatchedCount++;
+        return;
+    }
+
+    if (kind == 0x41) {
+        if (bytes < 9) return;
+        match->challenged = true;
+        memcpy(match->challenge, data + 5, sizeof(match->challenge));
+        match->sent = std::chrono::steady_clock::now();
+        challengedCount++;
+        Send(match);
+        return;
+    }
+
+    Datagram* reply = receiving;
+    receiving = datagrams.Acquire();
+    if (!receiving) {
+        receiving = reply;
+        return;
+    }
+    Complete(match, reply, bytes);
+}
+
+void QueryEngine::DispatchSplit(int bytes, uint64_t key) {
+    const uint8_t* data = receiving->data;
+    uint32_t id = data[4] | (data[5] << 8) | (data[6] << 16) | (static_cast<uint32_t>(data[7]) << 24);
+    uint8_t total = data[8];
+    uint8_t number = data[9];
+    if (total == 0 || total > QUERYENGINE_MAX_SPLIT_PARTS || number >= total || (id & 0x80000000)) {
+        unmatchedCount++;
+        return;
+    }
+
+    const uint8_t* payload = data + QUERYENGINE_SPLIT_HEADER;
+    bool first = number == 0 && bytes >= QUERYENGINE_SPLIT_HEADER + 5;
+    Request* match = nullptr;
+    for (Request* request = GetBucket(key); request; request = request->nextInBucket) {
+        if (request->key != key) continue;
+        if (!request->splitParts.empty()) {
+            if (request->splitId == id) {
+                match = request;
+                break;
+            }
+            continue;
+        }
+
+        bool wanted = !first || GetReplyType(request->awaiter->type) == payload[4];
+        if (wanted && (!match || request->sent < match->sent)) {
+            match = request;
+        }
+    }
+
+    if (!match || (!match->splitParts.empty() && match->splitParts.size() != total)) {
+        unmatchedCount++;
+        return;
+    }
+
+    if (match->splitParts.empty()) {
+        match->splitId = id;
+        match->splitReceived = 0;
+        match->splitParts.resize(total);
+    }
+    std::vector<uint8_t>& part = match->splitParts[number];
+    if (!part.empty()) return;
+    part.assign(payload, data + bytes);
+    if (++match->splitReceived < total) return;
+
+    Datagram* reply = datagrams.Acquire();
+    if (!reply) return;
+
+    for (const std::vector<uint8_t>& received : match->splitParts) {
+        reply->assembled.insert(reply->assembled.end(), received.begin(), received.end());
+    }
+    const std::vector<uint8_t>& assembled = reply->assembled;
+    if (assembled.size() < 5 || assembled[0] != 0xFF || assembled[1] != 0xFF || assembled[2] != 0xFF || assembled[3] != 0xFF ||
+        assembled[4] != GetReplyType(match->awaiter->type)) {
+        datagrams.Release(reply);
+        match->splitParts.clear();
+        unmatchedCount++;
+        return;
+    }
+    Complete(match, reply, static_cast<int>(assembled.size()));
+}
+
+void QueryEngine::Complete(Request* request, Datagram* reply, int size) {
+    reply->size = size;
+    request->awaiter->result.reply = DatagramRef(&datagrams, reply);
+    Finish(request, true);
+}
+
+void QueryEngine::Finish(Request* request, bool ok) {
+    Unlink(request);
+    RemoveDeadline(request);
+
+    ExchangeAwaiter* awaiter = request->awaiter;
+    awaiter->result.ok = ok;
+    if (ok) {
+        awaiter->result.latencyMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - request->sent).count());
+        completedCount++;
+    }
+    ready.push_back(awaiter->waiter);
+
+    while (ExchangeAwaiter* joiner = request->joined) {
+        request->joined = joiner->next;
+        joiner->next = nullptr;
+        joiner->result.ok = ok;
+        if (ok) {
+            joiner->result.reply = awaiter->result.reply.Share();
+            joiner->result.latencyMs = awaiter->result.latencyMs;
+        }
+        ready.push_back(joiner->waiter);
+    }
+    requests.Release(request);
+}
+
+void QueryEngine::Fail(ExchangeAwaiter* awaiter) {
+    awaiter->result.ok = false;
+    ready.push_back(awaiter->waiter);
+}
+
+void QueryEngine::ExpireRequests() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    while (!deadlines.empty() && deadlines.front()->deadline <= now) {
+        Request* request = deadlines.front();
+        if (request->attempts > request->awaiter->retries) {
+            timedOutCount++;
+            Finish(request, false);
+            continue;
+        }
+
+        request->attempts++;
+        request->splitParts.clear();
+        request->sent = now;
+        request->deadline = now + std::chrono::milliseconds(request->awaiter->timeoutMs);
+        SiftDown(0);
+        retriedCount++;
+        Send(request);
+    }
+}
+
+void QueryEngine::CancelRequests() {
+    bool found = true;
+    while (found) {
+        found = false;
+        for (size_t i = 0; i < deadlines.size(); ++i) {
+            Request* request = deadlines[i];
+            for (ExchangeAwaiter** link = &request->joined; *link;) {
+                ExchangeAwaiter* joiner = *link;
+                if (joiner->cancel && joiner->cancel->IsCancelled()) {
+                    *link = joiner->next;
+                    joiner->next = nullptr;
+                    cancelledCount++;
+                    Fail(joiner);
+                }
+                else {
+                    link = &joiner->next;
+                }
+            }
+
+            CancellationToken* cancel = request->awaiter->cancel;
+            if (!cancel || !cancel->IsCancelled()) continue;
+
+            cancelledCount++;
+            if (request->joined) {
+                Fail(request->awaiter);
+                request->awaiter = request->joined;
+                request->joined = request->awaiter->next;
+                request->awaiter->next = nullptr;
+                continue;
+            }
+            Finish(request, false);
+            found = true;
+            break;
+        }
+    }
+}
+
+
+void QueryEngine::Unlink(Request* request) {
+    Request** link = &GetBucket(request->key);
+    while (*link && *link != request) {
+        link = &(*link)->nextInBucket;
+    }
+    if (*link) *link = request->nextInBucket;
+    request->nextInBucket = nullptr;
+}
+
+void QueryEngine::PushDeadline(Request* request) {
+    request->heapIndex = deadlines.size();
+    deadlines.push_back(request);
+    SiftUp(request->heapIndex);
+}
+
+void QueryEngine::RemoveDeadline(Request* request) {
+    size_t index = request->heapIndex;
+    Request* last = deadlines.back();
+    deadlines.pop_back();
+    if (last == request) return;
+
+    deadlines[index] = last;
+    last->heapIndex = index;
+    SiftDown(index);
+    SiftUp(last->heapIndex);
+}
+
+void QueryEngine::SiftUp(size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (deadlines[parent]->deadline <= deadlines[index]->deadline) break;
+
+        std::swap(deadlines[parent], deadlines[index]);
+        deadlines[parent]->heapIndex = parent;
+        deadlines[index]->heapIndex = index;
+        index = parent;
+    }
+}
+
+void QueryEngine::SiftDown(size_t index) {
+    while (true) {
+        size_t smallest = index;
+        size_t left = index * 2 + 1;
+        size_t right = left + 1;
+        if (left < deadlines.size() && deadlines[left]->deadline < deadlines[smallest]->deadline) smallest = left;
+        if (right < deadlines.size() && deadlines[right]->deadline < deadlines[smallest]->deadline) smallest = right;
+        if (smallest == index) break;
+
+        std::swap(deadlines[smallest], deadlines[index]);
+        deadlines[smallest]->heapIndex = smallest;
+        deadlines[index]->heapIndex = index;
+        index = smallest;
+    }
+}
+
+
+size_t QueryEngine::BuildRequest(uint8_t type, const uint8_t* challenge, uint8_t* packet) {
+    static const char infoPayload[] = "Source Engine Query";
+    static const uint8_t noChallenge[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+    size_t size = 0;
+    memset(packet, 0xFF, 4);
+    size += 4;
+    packet[size++] = type;
+    if (type == A2S_INFO) {
+        memcpy(packet + size, infoPayload, sizeof(infoPayload));
+        size += sizeof(infoPayload);
+    }
+    if (type != A2S_INFO || challenge) {
+        memcpy(packet + size, challenge ? challenge : noChallenge, 4);
+        size += 4;
+    }
+    return size;
+}
+
+uint8_t QueryEngine::GetReplyType(uint8_t type) {
+    switch (type) {
+    case A2S_INFO: return 0x49;
+    case A2S_PLAYER: return 0x44;
+    case A2S_RULES: return 0x45;
+    default: return 0;
+    }
+}
+
+uint64_t QueryEngine::GetAddressKey(const sockaddr_in& address) {
+    return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+
+QueryTask<QueryResult<A2SInfoResponse>> QueryEngine::QueryInfo(std::string ip, int port, int retries) {
+    QueryResult<A2SInfoResponse> result;
+    QueryExchange reply = co_await Exchange(ip, port, A2S_INFO, QUERYENGINE_TIMEOUT_MS, retries);
+    if (reply.ok) {
+        PacketBuffer data(reply.reply.data(), reply.reply.data() + reply.reply.size(), ScanArena::Current());
+        transport.ParseA2SInfo(data, result.response);
+        result.ok = !result.response.name.empty() && result.response.name != "Parse Error";
+        result.latencyMs = reply.latencyMs;
+    }
+    co_return result;
+}
+
+QueryTask<QueryResult<A2SPlayerResponse>> QueryEngine::QueryPlayers(std::string ip, int port, int retries) {
+    QueryResult<A2SPlayerResponse> result;
+    QueryExchange reply = co_await Exchange(ip, port, A2S_PLAYER, QUERYENGINE_TIMEOUT_MS, retries);
+    if (reply.ok) {
+        PacketBuffer data(reply.reply.data(), reply.reply.data() + reply.reply.size(), ScanArena::Current());
+        transport.ParseA2SPlayer(data, result.response);
+        result.ok = true;
+        result.latencyMs = reply.latencyMs;
+    }
+    co_return result;
+}
+
+QueryTask<QueryResult<A2SRulesResponse>> QueryEngine::QueryRules(std::string ip, int port, int retries) {
+    QueryResult<A2SRulesResponse> result;
+    QueryExchange reply = co_await Exchange(ip, port, A2S_RULES, QUERYENGINE_TIMEOUT_MS, retries);
+    if (reply.ok) {
+        PacketBuffer data(reply.reply.data(), reply.reply.data() + reply.reply.size(), ScanArena::Current());
+        transport.ParseA2SRules(data, result.response);
+        result.ok = true;
+        result.latencyMs = reply.latencyMs;
+    }
+    co_return result;
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "Platform.h"
+#include <coroutine>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "ServerQuery.h"
+#include "ThreadPool.h"
+#include "CancellationToken.h"
+#include "SlabPool.h"
+#include "QueryTask.h"
+
+
+#define QUERYENGINE_TIMEOUT_MS      5000
+#define QUERYENGINE_IDLE_WAIT_MS    1000
+#define QUERYENGINE_RECEIVE_BUFFER  (1024 * 1024)
+#define QUERYENGINE_MAX_IN_FLIGHT   256
+#define QUERYENGINE_SPLIT_HEADER    12
+#define QUERYENGINE_MAX_SPLIT_PARTS 32
+
+
+struct Datagram {
+    uint8_t data[A2S_PACKET_SIZE];
+    int size = 0;
+    std::vector<uint8_t> assembled;
+    std::atomic<int> refs{ 1 };
+};
+
+
+class DatagramRef {
+public:
+    DatagramRef() = default;
+    DatagramRef(SlabPool<Datagram>* pool, Datagram* datagram) : pool(pool), datagram(datagram) {}
+    DatagramRef(DatagramRef&& other) noexcept : pool(other.pool), datagram(std::exchange(other.datagram, nullptr)) {}
+    ~DatagramRef() { Reset(); }
+
+    DatagramRef& operator=(DatagramRef&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            pool = other.pool;
+            datagram = std::exchange(other.datagram, nullptr);
+        }
+        return *this;
+    }
+
+    DatagramRef(const DatagramRef&) = delete;
+    DatagramRef& operator=(const DatagramRef&) = delete;
+
+    const uint8_t* data() const {
+        if (!datagram) return nullptr;
+        return datagram->assembled.empty() ? datagram->data : datagram->assembled.data();
+    }
+    size_t size() const { return datagram ? static_cast<size_t>(datagram->size) : 0; }
+
+    DatagramRef Share() const {
+        if (datagram) datagram->refs++;
+        return DatagramRef(pool, datagram);
+    }
+
+    void Reset() {
+        if (datagram) {
+            if (--datagram->refs == 0) pool->Release(datagram);
+            datagram = nullptr;
+        }
+    }
+
+private:
+    SlabPool<Datagram>* pool = nullptr;
+    Datagram* datagram = nullptr;
+};
+
+
+template <typename T>
+struct QueryResult {
+    bool ok = false;
+    T response{};
+    int latencyMs = -1;
+};
+
+struct QueryExchange {
+    bool ok = false;
+    DatagramRef reply;
+    int latencyMs = -1;
+};
+
+struct QueryEngineStats {
+    uint64_t sent = 0;
+    uint64_t joined = 0;
+    uint64_t completed = 0;
+    uint64_t timedOut = 0;
+    uint64_t retried = 0;
+    uint64_t challenged = 0;
+    uint64_t cancelled = 0;
+    uint64_t unmatched = 0;
+    size_t backlog = 0;
+    size_t peakBacklog = 0;
+    SlabPoolStats requests;
+    SlabPoolStats datagrams;
+    FramePoolStats frames;
+
+    std::string Format() const;
+};
+
+
+class QueryEngine {
+public:
+    QueryEngine();
+    ~QueryEngine();
+
+    QueryEngine(const QueryEngine&) = delete;
+    QueryEngine& operator=(const QueryEngine&) = delete;
+
+    bool Start(size_t maxInFlight = QUERYENGINE_MAX_IN_FLIGHT);
+    void Stop();
+    void Wake() { transport.Interrupt(); }
+    size_t GetMaxInFlight() const { return maxInFlight; }
+
+    class ExchangeAwaiter {
+    public:
+        ExchangeAwaiter(QueryEngine& engine, const std::string& ip, int port, uint8_t type, int timeoutMs, int retries);
+
+        bool await_ready() const noexcept { return !valid; }
+        QueryExchange await_resume() { return std::move(result); }
+
+        template <typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            if constexpr (std::is_base_of_v<QueryTaskDetail::PromiseBase, Promise>) {
+                if (handle.promise().cancel) cancel = handle.promise().cancel;
+            }
+            return Suspend(handle);
+        }
+
+    private:
+        friend class QueryEngine;
+
+        bool Suspend(std::coroutine_handle<> handle);
+
+        QueryEngine& engine;
+        sockaddr_in address;
+        bool valid;
+        uint8_t type;
+        int timeoutMs;
+        int retries;
+        CancellationToken* cancel;
+        std::coroutine_handle<> waiter;
+        ExchangeAwaiter* next = nullptr;
+        QueryExchange result;
+    };
+
+    template <typename F>
+    class OffloadAwaiter {
+    public:
+        typedef std::invoke_result_t<F> Result;
+        static_assert(!std::is_void_v<Result>, "Offloaded work must return a value");
+
+        OffloadAwaiter(QueryEngine& engine, ThreadPool& pool, F function)
+            : engine(engine), pool(pool), function(std::move(function)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            CancellationToken* cancel = CancellationToken::Current();
+            if constexpr (std::is_base_of_v<QueryTaskDetail::PromiseBase, Promise>) {
+                if (handle.promise().cancel) cancel = handle.promise().cancel;
+            }
+
+            if (pool.Post([this, handle, cancel]() {
+                CancellationToken::Scope cancelScope(cancel);
+                result = function();
+                if (!engine.Post(handle)) handle.resume();
+                })) {
+                return true;
+            }
+            result = function();
+            return false;
+        }
+
+        Result await_resume() { return std::move(result); }
+
+    private:
+        QueryEngine& engine;
+        ThreadPool& pool;
+        F function;
+        Result result{};
+    };
+
+    ExchangeAwaiter Exchange(const std::string& ip, int port, uint8_t type,
+        int timeoutMs = QUERYENGINE_TIMEOUT_MS, int retries = 0) {
+        return ExchangeAwaiter(*this, ip, port, type, timeoutMs, retries);
+    }
+
+    template <typename F>
+    OffloadAwaiter<std::decay_t<F>> Offload(ThreadPool& pool, F&& function) {
+        return OffloadAwaiter<std::decay_t<F>>(*this, pool, std::forward<F>(function));
+    }
+
+    QueryTask<QueryResult<A2SInfoResponse>> QueryInfo(std::string ip, int port, int retries = 0);
+    QueryTask<QueryResult<A2SPlayerResponse>> QueryPlayers(std::string ip, int port, int retries = 0);
+    QueryTask<QueryResult<A2SRulesResponse>> QueryRules(std::string ip, int port, int retries = 0);
+
+    bool Post(std::coroutine_handle<> handle);
+    QueryEngineStats GetStats() const;
+
+private:
+    struct Request {
+        ExchangeAwaiter* awaiter = nullptr;
+        ExchangeAwaiter* joined = nullptr;
+        Request* nextInBucket = nullptr;
+        uint64_t key = 0;
+        size_t heapIndex = 0;
+        std::chrono::steady_clock::time_point sent;
+        std::chrono::steady_clock::time_point deadline;
+        int attempts = 0;
+        bool challenged = false;
+        uint8_t challenge[4] = {};
+        uint32_t splitId = 0;
+        uint8_t splitReceived = 0;
+        std::vector<std::vector<uint8_t>> splitParts;
+    };
+
+    bool Submit(ExchangeAwaiter* awaiter);
+    void Run();
+    void Begin(Request* request, ExchangeAwaiter* awaiter);
+    Request* FindFlight(const ExchangeAwaiter* awaiter);
+    void Join(Request* request, ExchangeAwaiter* awaiter);
+    void Send(Request* request);
+    void Dispatch(int bytes, const sockaddr_in& from);
+    void DispatchSplit(int bytes, uint64_t key);
+    void Complete(Request* request, Datagram* reply, int size);
+    void Finish(Request* request, bool ok);
+    void Fail(ExchangeAwaiter* awaiter);
+    void ExpireRequests();
+    void CancelRequests();
+
+    Request*& GetBucket(uint64_t key) { return buckets[(key * 0x9E3779B97F4A7C15ULL) >> bucketShift]; }
+    void Unlink(Request* request);
+    void PushDeadline(Request* request);
+    void RemoveDeadline(Request* request);
+    void SiftUp(size_t index);
+    void SiftDown(size_t index);
+
+    static size_t BuildRequest(uint8_t type, const uint8_t* challenge, uint8_t* packet);
+    static uint8_t GetReplyType(uint8_t type);
+    static uint64_t GetAddressKey(const sockaddr_in& address);
+
+    ServerQueryManager transport;
+    std::thread loopThread;
+    size_t maxInFlight = 0;
+
+    mutable std::mutex mutex;
+    bool running = false;
+    bool stopping = false;
+    ExchangeAwaiter* submittedHead = nullptr;
+    ExchangeAwaiter* submittedTail = nullptr;
+    std::vector<std::coroutine_handle<>> posted;
+
+    SlabPool<Request> requests;
+    SlabPool<Datagram> datagrams;
+    std::vector<Request*> buckets;
+    int bucketShift = 63;
+    std::vector<Request*> deadlines;
+    ExchangeAwaiter* backlogHead = nullptr;
+    ExchangeAwaiter* backlogTail = nullptr;
+    std::vector<std::coroutine_handle<>> ready;
+    Datagram* receiving = nullptr;
+    uint8_t packet[A2S_PACKET_SIZE];
+
+    std::atomic<uint64_t> sentCount{ 0 };
+    std::atomic<uint64_t> joinedCount{ 0 };
+    std::atomic<uint64_t> completedCount{ 0 };
+    std::atomic<uint64_t> timedOutCount{ 0 };
+    std::atomic<uint64_t> retriedCount{ 0 };
+    std::atomic<uint64_t> challengedCount{ 0 };
+    std::atomic<uint64_t> cancelledCount{ 0 };
+    std::atomic<uint64_t> unmatchedCount{ 0 };
+    std::atomic<size_t> backlogSize{ 0 };
+    std::atomic<size_t> peakBacklog{ 0 };
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Platform.h"
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include "SlabPool.h"
+#include "CancellationToken.h"
+
+
+template <typename T = void>
+class QueryTask;
+
+
+namespace QueryTaskDetail {
+    struct PromiseBase {
+        std::coroutine_handle<> continuation;
+        CancellationToken* cancel = CancellationToken::Current();
+        bool detached = false;
+
+        static void* operator new(size_t size) { return FramePool::Instance().Allocate(size); }
+        static void operator delete(void* frame, size_t size) { FramePool::Instance().Deallocate(frame, size); }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                PromiseBase& promise = handle.promise();
+                if (promise.continuation) return promise.continuation;
+                if (promise.detached) handle.destroy();
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() const noexcept { OutputDebugStringA("Unhandled exception in query task\n"); }
+    };
+
+    template <typename T>
+    struct Promise : PromiseBase {
+        T value{};
+
+        QueryTask<T> get_return_object() noexcept;
+
+        template <typename U>
+        void return_value(U&& result) { value = std::forward<U>(result); }
+    };
+
+    template <>
+    struct Promise<void> : PromiseBase {
+        QueryTask<void> get_return_object() noexcept;
+        void return_void() const noexcept {}
+    };
+}
+
+
+template <typename T>
+class QueryTask {
+public:
+    typedef QueryTaskDetail::Promise<T> promise_type;
+
+    QueryTask() = default;
+    explicit QueryTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    QueryTask(QueryTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    ~QueryTask() { Reset(); }
+
+    QueryTask& operator=(QueryTask&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    QueryTask(const QueryTask&) = delete;
+    QueryTask& operator=(const QueryTask&) = delete;
+
+    void Detach() {
+        if (!handle) return;
+        std::coroutine_handle<promise_type> started = std::exchange(handle, {});
+        started.promise().detached = true;
+        started.resume();
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept {
+        if constexpr (std::is_base_of_v<QueryTaskDetail::PromiseBase, Promise>) {
+            if (!handle.promise().cancel) handle.promise().cancel = awaiting.promise().cancel;
+        }
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() {
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(handle.promise().value);
+        }
+    }
+
+private:
+    void Reset() {
+        if (handle) {
+            handle.destroy();
+            handle = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+
+namespace QueryTaskDetail {
+    template <typename T>
+    QueryTask<T> Promise<T>::get_return_object() noexcept {
+        return QueryTask<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline QueryTask<void> Promise<void>::get_return_object() noexcept {
+        return QueryTask<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+}
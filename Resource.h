@@ -178,8 +178,10 @@
 #define FILTER_NOT_FULL        0x80
 
 
-#define WM_UPDATE_PROGRESS      (WM_USER + 1)
-#define WM_REFRESH_COMPLETE     (WM_USER + 2)
 #define WM_TRAYICON             (WM_USER + 3)
 #define WM_REFRESH_PARTIAL      (WM_USER + 4)
+#define WM_FILTER_READY         (WM_USER + 5)
+
+#define IDT_SCAN_DRAIN          2
+#define SCAN_DRAIN_INTERVAL_MS  33
 
@@ -0,0 +1,85 @@
+#include "RowBitmap.h"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+void RowBitmap::Assign(size_t bits, bool value) {
+    bitCount = bits;
+    words.assign((bits + 63) >> 6, value ? ~uint64_t(0) : 0);
+    TrimTail();
+}
+
+void RowBitmap::Resize(size_t bits) {
+    bitCount = bits;
+    words.resize((bits + 63) >> 6, 0);
+    TrimTail();
+}
+
+void RowBitmap::TrimTail() {
+    if (bitCount & 63) {
+        words.back() &= (uint64_t(1) << (bitCount & 63)) - 1;
+    }
+}
+
+RowBitmap& RowBitmap::And(const RowBitmap& other) {
+    size_t shared = (std::min)(words.size(), other.words.size());
+    for (size_t w = 0; w < shared; ++w) {
+        words[w] &= other.words[w];
+    }
+    std::fill(words.begin() + shared, words.end(), 0);
+    return *this;
+}
+
+RowBitmap& RowBitmap::AndNot(const RowBitmap& other) {
+    size_t shared = (std::min)(words.size(), other.words.size());
+    for (size_t w = 0; w < shared; ++w) {
+        words[w] &= ~other.words[w];
+    }
+    return *this;
+}
+
+RowBitmap& RowBitmap::Or(const RowBitmap& other) {
+    if (other.bitCount > bitCount) Resize(other.bitCount);
+    for (size_t w = 0; w < other.words.size(); ++w) {
+        words[w] |= other.words[w];
+    }
+    return *this;
+}
+
+size_t RowBitmap::Count() const {
+    size_t count = 0;
+    for (uint64_t word : words) {
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        count += static_cast<size_t>((word * 0x0101010101010101ULL) >> 56);
+    }
+    return count;
+}
+
+bool RowBitmap::Any() const {
+    for (uint64_t word : words) {
+        if (word) return true;
+    }
+    return false;
+}
+
+size_t RowBitmap::LowestBit(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+#ifdef _M_X64
+    _BitScanForward64(&index, word);
+#else
+    if (!_BitScanForward(&index, static_cast<uint32_t>(word))) {
+        _BitScanForward(&index, static_cast<uint32_t>(word >> 32));
+        index += 32;
+    }
+#endif
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+class RowBitmap {
+public:
+    RowBitmap() : bitCount(0) {}
+    explicit RowBitmap(size_t bits, bool value = false) { Assign(bits, value); }
+
+    void Assign(size_t bits, bool value);
+    void Resize(size_t bits);
+    void Clear() { words.clear(); bitCount = 0; }
+
+    size_t size() const { return bitCount; }
+    bool empty() const { return bitCount == 0; }
+
+    bool Test(size_t bit) const {
+        return bit < bitCount && (words[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    void Set(size_t bit, bool value = true) {
+        if (bit >= bitCount) Resize(bit + 1);
+        uint64_t mask = uint64_t(1) << (bit & 63);
+        if (value) words[bit >> 6] |= mask;
+        else words[bit >> 6] &= ~mask;
+    }
+
+    void Reset(size_t bit) { Set(bit, false); }
+
+    RowBitmap& And(const RowBitmap& other);
+    RowBitmap& AndNot(const RowBitmap& other);
+    RowBitmap& Or(const RowBitmap& other);
+
+    size_t Count() const;
+    bool Any() const;
+
+    template <typename Callback>
+    void ForEach(Callback callback) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            uint64_t word = words[w];
+            while (word) {
+                callback((w << 6) + LowestBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    size_t GetMemoryUsage() const { return words.capacity() * sizeof(uint64_t); }
+
+private:
+    static size_t LowestBit(uint64_t word);
+    void TrimTail();
+
+    std::vector<uint64_t> words;
+    size_t bitCount;
+};
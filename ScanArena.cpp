@@ -0,0 +1,58 @@
+#include "ScanArena.h"
+
+
+static thread_local std::pmr::memory_resource* currentScanResource = nullptr;
+
+
+ScanArena::ScanArena(size_t initialBlockSize)
+    : heap(std::pmr::new_delete_resource()),
+      monotonic(initialBlockSize, &heap),
+      recycler(&monotonic),
+      front(&recycler) {
+}
+
+ScanArenaStats ScanArena::GetStats() const {
+    ScanArenaStats stats;
+    stats.allocations = front.allocations;
+    stats.bytesRequested = front.bytes;
+    stats.heapBlocks = heap.allocations;
+    stats.heapBytes = heap.bytes;
+    return stats;
+}
+
+std::string ScanArena::FormatStats() const {
+    ScanArenaStats stats = GetStats();
+    return "Scan arena: " + std::to_string(stats.allocations) + " allocations (" +
+        std::to_string(stats.bytesRequested / 1024) + " KB) served from " +
+        std::to_string(stats.heapBlocks) + " heap blocks (" +
+        std::to_string(stats.heapBytes / 1024) + " KB)";
+}
+
+std::pmr::memory_resource* ScanArena::Current() {
+    return currentScanResource ? currentScanResource : std::pmr::new_delete_resource();
+}
+
+
+ScanArena::Scope::Scope(ScanArena& arena) : previous(currentScanResource) {
+    currentScanResource = arena.GetResource();
+}
+
+ScanArena::Scope::~Scope() {
+    currentScanResource = previous;
+}
+
+
+void* ScanArena::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    void* p = upstream->allocate(bytes, alignment);
+    allocations++;
+    this->bytes += bytes;
+    return p;
+}
+
+void ScanArena::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    upstream->deallocate(p, bytes, alignment);
+}
+
+bool ScanArena::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+
+#define SCAN_ARENA_INITIAL_BLOCK    (256 * 1024)
+#define A2S_PACKET_SIZE             1400
+
+
+typedef std::pmr::vector<uint8_t> PacketBuffer;
+
+
+struct ScanArenaStats {
+    size_t allocations = 0;
+    size_t bytesRequested = 0;
+    size_t heapBlocks = 0;
+    size_t heapBytes = 0;
+};
+
+
+class ScanArena {
+public:
+    explicit ScanArena(size_t initialBlockSize = SCAN_ARENA_INITIAL_BLOCK);
+    ScanArena(const ScanArena&) = delete;
+    ScanArena& operator=(const ScanArena&) = delete;
+
+    std::pmr::memory_resource* GetResource() { return &front; }
+    ScanArenaStats GetStats() const;
+    std::string FormatStats() const;
+
+    static std::pmr::memory_resource* Current();
+
+    class Scope {
+    public:
+        explicit Scope(ScanArena& arena);
+        ~Scope();
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        std::pmr::memory_resource* previous;
+    };
+
+private:
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+
+        size_t allocations = 0;
+        size_t bytes = 0;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        std::pmr::memory_resource* upstream;
+    };
+
+    CountingResource heap;
+    std::pmr::monotonic_buffer_resource monotonic;
+    std::pmr::unsynchronized_pool_resource recycler;
+    CountingResource front;
+};
@@ -0,0 +1,18 @@
+#include "ScanPipeline.h"
+#include <cstdio>
+
+
+std::string PipelineStageStats::Format() const {
+    double seconds = elapsedMs / 1000.0;
+    double throughput = seconds > 0.0 ? processed / seconds : 0.0;
+    double utilization = (elapsedMs > 0.0 && workers) ? 100.0 * busyMs / (elapsedMs * workers) : 0.0;
+
+    char buffer[384];
+    snprintf(buffer, sizeof(buffer),
+        "Stage %s: %d workers, %d items in %.0f ms (%.1f/s, %.0f%% busy), queue avg %.1f peak %d/%d, "
+        "%d blocked pushes (%.0f ms), %d dropped",
+        name.c_str(), static_cast<int>(workers), static_cast<int>(processed), elapsedMs, throughput, utilization,
+        queue.averageOccupancy, static_cast<int>(queue.highWater), static_cast<int>(queue.capacity),
+        static_cast<int>(queue.blockedPushes), queue.blockedMs, static_cast<int>(queue.dropped));
+    return buffer;
+}
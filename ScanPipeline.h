@@ -0,0 +1,275 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "CancellationToken.h"
+#include "ScanArena.h"
+
+
+#define SCANPIPELINE_QUEUE_SIZE     256
+#define SCANPIPELINE_MAX_WORKERS    16
+
+
+struct PipelineQueueStats {
+    size_t capacity = 0;
+    size_t size = 0;
+    size_t highWater = 0;
+    uint64_t pushed = 0;
+    uint64_t dropped = 0;
+    uint64_t blockedPushes = 0;
+    double blockedMs = 0.0;
+    double averageOccupancy = 0.0;
+};
+
+struct PipelineStageStats {
+    std::string name;
+    size_t workers = 0;
+    uint64_t processed = 0;
+    double elapsedMs = 0.0;
+    double busyMs = 0.0;
+    PipelineQueueStats queue;
+
+    std::string Format() const;
+};
+
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity((std::max)(capacity, size_t(1))) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool Push(T value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!WaitForSpace(lock, nullptr)) return false;
+        Add(std::move(value));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool Push(T& value, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!WaitForSpace(lock, &timeout)) return false;
+        Add(std::move(value));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool TryPush(T& value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (closed) return false;
+        if (items.size() >= capacity) {
+            dropped++;
+            return false;
+        }
+        Add(std::move(value));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool Pop(T& value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]() { return !items.empty() || closed; });
+        if (items.empty()) return false;
+
+        value = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    void Abort() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            dropped += items.size();
+            items.clear();
+        }
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    bool IsClosed() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+
+    PipelineQueueStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        PipelineQueueStats stats;
+        stats.capacity = capacity;
+        stats.size = items.size();
+        stats.highWater = highWater;
+        stats.pushed = pushed;
+        stats.dropped = dropped;
+        stats.blockedPushes = blockedPushes;
+        stats.blockedMs = std::chrono::duration<double, std::milli>(blockedTime).count();
+        stats.averageOccupancy = pushed ? static_cast<double>(occupancySum) / pushed : 0.0;
+        return stats;
+    }
+
+private:
+    bool WaitForSpace(std::unique_lock<std::mutex>& lock, const std::chrono::milliseconds* timeout) {
+        if (closed) return false;
+        if (items.size() < capacity) return true;
+
+        blockedPushes++;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        auto ready = [this]() { return items.size() < capacity || closed; };
+        if (timeout) notFull.wait_for(lock, *timeout, ready);
+        else notFull.wait(lock, ready);
+        blockedTime += std::chrono::steady_clock::now() - start;
+
+        return !closed && items.size() < capacity;
+    }
+
+    void Add(T&& value) {
+        occupancySum += items.size();
+        items.push_back(std::move(value));
+        pushed++;
+        highWater = (std::max)(highWater, items.size());
+    }
+
+    const size_t capacity;
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<T> items;
+    bool closed = false;
+
+    size_t highWater = 0;
+    uint64_t pushed = 0;
+    uint64_t dropped = 0;
+    uint64_t blockedPushes = 0;
+    uint64_t occupancySum = 0;
+    std::chrono::steady_clock::duration blockedTime{ 0 };
+};
+
+
+struct NoStageContext {
+    void Interrupt() {}
+};
+
+
+template <typename In, typename Context = NoStageContext>
+class PipelineStage {
+public:
+    explicit PipelineStage(const char* name, size_t capacity = SCANPIPELINE_QUEUE_SIZE) : name(name), input(capacity) {}
+    ~PipelineStage() {
+        Abort();
+        Join();
+    }
+
+    PipelineStage(const PipelineStage&) = delete;
+    PipelineStage& operator=(const PipelineStage&) = delete;
+
+    BoundedQueue<In>& Input() { return input; }
+
+    template <typename Process>
+    bool Start(size_t workerCount, CancellationToken* cancel, Process process) {
+        return Start(workerCount, cancel, process, [](Context&) {});
+    }
+
+    template <typename Process, typename Setup>
+    bool Start(size_t workerCount, CancellationToken* cancel, Process process, Setup setup) {
+        workerCount = (std::min)((std::max)(workerCount, size_t(1)), size_t(SCANPIPELINE_MAX_WORKERS));
+        started = std::chrono::steady_clock::now();
+
+        try {
+            for (size_t i = 0; i < workerCount; ++i) {
+                running++;
+                workers.emplace_back([this, cancel, process, setup]() mutable { Work(cancel, process, setup); });
+            }
+        }
+        catch (...) {
+            running--;
+            Abort();
+            return false;
+        }
+        return true;
+    }
+
+    void Close() { input.Close(); }
+    void Abort() { input.Abort(); }
+    bool IsFinished() const { return running.load() == 0; }
+
+    void Join() {
+        for (std::thread& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    PipelineStageStats GetStats() const {
+        PipelineStageStats stats;
+        stats.name = name;
+        stats.workers = workers.size();
+        stats.processed = processed.load();
+        stats.busyMs = busyMicros.load() / 1000.0;
+        stats.queue = input.GetStats();
+
+        int64_t finished = finishedMicros.load();
+        if (workers.empty()) stats.elapsedMs = 0.0;
+        else if (finished >= 0) stats.elapsedMs = finished / 1000.0;
+        else stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        return stats;
+    }
+
+private:
+    template <typename Process, typename Setup>
+    void Work(CancellationToken* cancel, Process& process, Setup& setup) {
+        {
+            ScanArena arena;
+            ScanArena::Scope arenaScope(arena);
+            CancellationToken::Scope cancelScope(cancel);
+            Context context;
+            setup(context);
+            CancellationToken::Registration wake(cancel, [&context]() { context.Interrupt(); });
+
+            In item;
+            while (!(cancel && cancel->IsCancelled()) && input.Pop(item)) {
+                std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                process(item, context);
+                busyMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+                processed++;
+            }
+        }
+
+        if (running.fetch_sub(1) == 1) {
+            finishedMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+        }
+    }
+
+    const char* name;
+    BoundedQueue<In> input;
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point started;
+    std::atomic<size_t> running{ 0 };
+    std::atomic<uint64_t> processed{ 0 };
+    std::atomic<int64_t> busyMicros{ 0 };
+    std::atomic<int64_t> finishedMicros{ -1 };
+};
@@ -0,0 +1,228 @@
+#include "ServerFilter.h"
+#include "resource.h"
+
+
+bool FilterCriteria::operator==(const FilterCriteria& other) const {
+    return tab == other.tab && flags == other.flags && query == other.query;
+}
+
+int FilterCriteria::GetPerspectiveMask() const {
+    int perspective = flags & (FILTER_FIRST_PERSON | FILTER_THIRD_PERSON);
+    if (perspective == 0) {
+        perspective = FILTER_FIRST_PERSON | FILTER_THIRD_PERSON;
+    }
+    return perspective;
+}
+
+void FilterCriteria::GetAttributeMasks(uint32_t& required, uint32_t& excluded) const {
+    required = query.GetRequiredAttributes();
+    excluded = query.GetExcludedAttributes();
+
+    if (tab == TAB_OFFICIAL) required |= 1u << SERVER_ATTR_OFFICIAL;
+    if (tab == TAB_COMMUNITY) excluded |= 1u << SERVER_ATTR_OFFICIAL;
+    if (tab == TAB_LAN) required |= 1u << SERVER_ATTR_LAN;
+
+    if (flags & FILTER_SHOW_FAVORITES) required |= 1u << SERVER_ATTR_FAVORITE;
+    if (flags & FILTER_SHOW_PLAYED) required |= 1u << SERVER_ATTR_PLAYED;
+    if (flags & FILTER_SHOW_MODDED) required |= 1u << SERVER_ATTR_MODDED;
+    if (flags & FILTER_ONLINE_ONLY) required |= 1u << SERVER_ATTR_ONLINE;
+    if (flags & FILTER_HIDE_PASSWORD) excluded |= 1u << SERVER_ATTR_PASSWORDED;
+    if (flags & FILTER_NOT_FULL) excluded |= 1u << SERVER_ATTR_FULL;
+
+    int perspective = GetPerspectiveMask();
+    if (perspective == FILTER_FIRST_PERSON) required |= 1u << SERVER_ATTR_FIRST_PERSON;
+    if (perspective == FILTER_THIRD_PERSON) required |= 1u << SERVER_ATTR_THIRD_PERSON;
+}
+
+bool FilterCriteria::IsNarrowerThan(const FilterCriteria& previous) const {
+    const int perspectiveFlags = FILTER_FIRST_PERSON | FILTER_THIRD_PERSON;
+
+    if (tab != previous.tab) return false;
+    if ((flags & previous.flags & ~perspectiveFlags) != (previous.flags & ~perspectiveFlags)) return false;
+    if ((GetPerspectiveMask() & previous.GetPerspectiveMask()) != GetPerspectiveMask()) return false;
+    return query.IsNarrowerThan(previous.query);
+}
+
+FilterCriteria FilterCriteria::WithoutField(FilterField field) const {
+    FilterCriteria relaxed = *this;
+    relaxed.query = query.WithoutField(field);
+    return relaxed;
+}
+
+
+void FilterEngine::Invalidate() {
+    valid = false;
+    if (mapView) mapView->Invalidate();
+    if (versionView) versionView->Invalidate();
+}
+
+std::vector<FacetCounts::Entry> FilterEngine::GetMapFacets() const {
+    return mapView ? mapView->resultFacets.GetMaps() : resultFacets.GetMaps();
+}
+
+std::vector<FacetCounts::Entry> FilterEngine::GetVersionFacets() const {
+    return versionView ? versionView->resultFacets.GetVersions() : resultFacets.GetVersions();
+}
+
+void FilterEngine::UpdateFacetView(std::unique_ptr<FilterEngine>& view, FilterField field, const ServerStore& store,
+    const FilterCriteria& criteria, const std::vector<uint32_t>* changed) {
+    if (!trackViews || !criteria.query.HasField(field)) {
+        view.reset();
+        return;
+    }
+    if (!view) {
+        view = std::make_unique<FilterEngine>();
+        view->trackViews = false;
+    }
+
+    FilterCriteria relaxed = criteria.WithoutField(field);
+    if (!changed || !view->ApplyChanges(store, relaxed, *changed, viewRemoved, viewAdded)) {
+        view->Apply(store, relaxed);
+    }
+}
+
+
+void FilterEngine::ApplyAttributes(const ServerStore& store, const FilterCriteria& criteria, RowBitmap& rows) const {
+    uint32_t required, excluded;
+    criteria.GetAttributeMasks(required, excluded);
+
+    for (int attribute = 0; attribute < SERVER_ATTR_COUNT; ++attribute) {
+        if (required & (1u << attribute)) rows.And(store.GetAttribute(attribute));
+        if (excluded & (1u << attribute)) rows.AndNot(store.GetAttribute(attribute));
+    }
+}
+
+bool FilterEngine::Matches(const ServerStore& store, const FilterCriteria& criteria, const TextSearch& term, uint32_t index) const {
+    ServerId id = store.GetSlotId(index);
+    const ServerInfo* server = store.Get(id);
+    if (!server) return false;
+
+    uint32_t required, excluded;
+    criteria.GetAttributeMasks(required, excluded);
+    for (int attribute = 0; attribute < SERVER_ATTR_COUNT; ++attribute) {
+        bool set = store.GetAttribute(attribute).Test(index);
+        if ((required & (1u << attribute)) && !set) return false;
+        if ((excluded & (1u << attribute)) && set) return false;
+    }
+
+    if (!term.empty() && !store.MatchesSearch(id, term)) return false;
+    return !criteria.query.HasProgram() || criteria.query.Evaluate(*server);
+}
+
+void FilterEngine::TrackFacets(const ServerStore& store, uint32_t index) {
+    if (index >= rowFacets.size()) {
+        rowFacets.resize(index + 1);
+    }
+    rowFacets[index] = store.GetFacetKey(index);
+    resultFacets.Add(rowFacets[index]);
+}
+
+bool FilterEngine::ApplyChanges(const ServerStore& store, const FilterCriteria& criteria, const std::vector<uint32_t>& changed,
+    std::vector<uint32_t>& removed, std::vector<uint32_t>& added) {
+    removed.clear();
+    added.clear();
+    if (!valid || criteria != lastCriteria) return false;
+
+    lastStats = FilterStats();
+    lastStats.incremental = true;
+
+    TextSearch term(criteria.query.GetSearchText());
+    for (uint32_t index : changed) {
+        lastStats.tested++;
+        if (lastBitmap.Test(index)) {
+            resultFacets.Remove(rowFacets[index]);
+            lastBitmap.Reset(index);
+            removed.push_back(index);
+        }
+        if (Matches(store, criteria, term, index)) {
+            lastBitmap.Set(index);
+            TrackFacets(store, index);
+            added.push_back(index);
+        }
+    }
+
+    lastRevision = store.GetRevision();
+    rowsCurrent = false;
+    lastStats.matched = lastBitmap.Count();
+
+    UpdateFacetView(mapView, FILTER_FIELD_MAP, store, criteria, &changed);
+    UpdateFacetView(versionView, FILTER_FIELD_VERSION, store, criteria, &changed);
+    return true;
+}
+
+const std::vector<ServerId>& FilterEngine::Apply(const ServerStore& store, const FilterCriteria& criteria) {
+    lastStats = FilterStats();
+
+    bool sameData = valid && lastRevision == store.GetRevision();
+    if (sameData && criteria == lastCriteria) {
+        if (!rowsCurrent) {
+            lastRows.clear();
+            for (auto it = store.begin(); it != store.end(); ++it) {
+                if (lastBitmap.Test(it.GetId().index)) lastRows.push_back(it.GetId());
+            }
+            rowsCurrent = true;
+        }
+        lastStats.cached = true;
+        lastStats.matched = lastRows.size();
+        return lastRows;
+    }
+
+    RowBitmap rows;
+    if (sameData && criteria.IsNarrowerThan(lastCriteria)) {
+        rows = lastBitmap;
+        const std::string& search = criteria.query.GetSearchText();
+        if (!search.empty() && search != lastCriteria.query.GetSearchText()) {
+            TextSearch term(search);
+            rows.ForEach([&](size_t index) {
+                lastStats.tested++;
+                if (!store.MatchesSearch(store.GetSlotId(static_cast<uint32_t>(index)), term)) rows.Reset(index);
+            });
+        }
+        lastStats.narrowed = true;
+    }
+    else {
+        rows = store.MatchSearch(criteria.query.GetSearchText());
+    }
+
+    ApplyAttributes(store, criteria, rows);
+
+    if (criteria.query.HasProgram()) {
+        rows.ForEach([&](size_t index) {
+            lastStats.tested++;
+            const ServerInfo* server = store.Get(store.GetSlotId(static_cast<uint32_t>(index)));
+            if (!server || !criteria.query.Evaluate(*server)) rows.Reset(index);
+        });
+    }
+
+    lastRows.clear();
+    for (auto it = store.begin(); it != store.end(); ++it) {
+        ServerId id = it.GetId();
+        if (rows.Test(id.index)) {
+            lastRows.push_back(id);
+        }
+    }
+
+    if (lastStats.narrowed) {
+        lastBitmap.AndNot(rows);
+        lastBitmap.ForEach([&](size_t index) {
+            resultFacets.Remove(rowFacets[index]);
+        });
+    }
+    else {
+        resultFacets.Clear();
+        rows.ForEach([&](size_t index) {
+            TrackFacets(store, static_cast<uint32_t>(index));
+        });
+    }
+
+    lastBitmap = std::move(rows);
+    lastCriteria = criteria;
+    lastRevision = store.GetRevision();
+    valid = true;
+    rowsCurrent = true;
+    lastStats.matched = lastRows.size();
+
+    UpdateFacetView(mapView, FILTER_FIELD_MAP, store, criteria, nullptr);
+    UpdateFacetView(versionView, FILTER_FIELD_VERSION, store, criteria, nullptr);
+    return lastRows;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "ServerStore.h"
+#include "TextSearch.h"
+#include "FilterQuery.h"
+
+
+struct FilterCriteria {
+    int tab = 0;
+    int flags = 0;
+    FilterQuery query;
+
+    bool operator==(const FilterCriteria& other) const;
+    bool operator!=(const FilterCriteria& other) const { return !(*this == other); }
+
+    bool IsNarrowerThan(const FilterCriteria& previous) const;
+    FilterCriteria WithoutField(FilterField field) const;
+    int GetPerspectiveMask() const;
+    void GetAttributeMasks(uint32_t& required, uint32_t& excluded) const;
+};
+
+
+struct FilterStats {
+    size_t tested = 0;
+    size_t matched = 0;
+    bool narrowed = false;
+    bool cached = false;
+    bool incremental = false;
+};
+
+
+class FilterEngine {
+public:
+    const std::vector<ServerId>& Apply(const ServerStore& store, const FilterCriteria& criteria);
+    bool ApplyChanges(const ServerStore& store, const FilterCriteria& criteria, const std::vector<uint32_t>& changed,
+        std::vector<uint32_t>& removed, std::vector<uint32_t>& added);
+    void Invalidate();
+
+    const FilterStats& GetLastStats() const { return lastStats; }
+    const FacetCounts& GetResultFacets() const { return resultFacets; }
+    std::vector<FacetCounts::Entry> GetMapFacets() const;
+    std::vector<FacetCounts::Entry> GetVersionFacets() const;
+
+private:
+    void ApplyAttributes(const ServerStore& store, const FilterCriteria& criteria, RowBitmap& rows) const;
+    bool Matches(const ServerStore& store, const FilterCriteria& criteria, const TextSearch& term, uint32_t index) const;
+    void TrackFacets(const ServerStore& store, uint32_t index);
+    void UpdateFacetView(std::unique_ptr<FilterEngine>& view, FilterField field, const ServerStore& store,
+        const FilterCriteria& criteria, const std::vector<uint32_t>* changed);
+
+    FilterCriteria lastCriteria;
+    RowBitmap lastBitmap;
+    std::vector<ServerId> lastRows;
+    FacetCounts resultFacets;
+    std::vector<FacetKey> rowFacets;
+    uint64_t lastRevision = 0;
+    bool valid = false;
+    bool rowsCurrent = false;
+    FilterStats lastStats;
+
+    bool trackViews = true;
+    std::unique_ptr<FilterEngine> mapView;
+    std::unique_ptr<FilterEngine> versionView;
+    std::vector<uint32_t> viewRemoved;
+    std::vector<uint32_t> viewAdded;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+
+#define SERVERSTORE_INVALID_INDEX   0xFFFFFFFFu
+
+
+struct ServerId {
+    uint32_t index;
+    uint32_t generation;
+
+    ServerId() : index(SERVERSTORE_INVALID_INDEX), generation(0) {}
+    ServerId(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+    bool IsValid() const { return index != SERVERSTORE_INVALID_INDEX; }
+
+    bool operator==(const ServerId& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const ServerId& other) const { return !(*this == other); }
+};
@@ -0,0 +1,103 @@
+#include "ServerListViewModel.h"
+#include <algorithm>
+
+
+void ServerListViewModel::Reset() {
+    rows.clear();
+    slotPositions.clear();
+}
+
+size_t ServerListViewModel::Find(ServerId id) const {
+    if (id.index >= slotPositions.size()) return LISTVIEWMODEL_NO_POSITION;
+
+    uint32_t position = slotPositions[id.index];
+    if (position == LISTVIEWMODEL_NO_POSITION || rows[position].id != id) return LISTVIEWMODEL_NO_POSITION;
+    return position;
+}
+
+void ServerListViewModel::Diff(const std::vector<ListRow>& next, std::vector<ListChange>& changes) {
+    changes.clear();
+    lastStats = ListDiffStats();
+
+    targets.assign(rows.size(), LISTVIEWMODEL_NO_POSITION);
+    for (size_t target = 0; target < next.size(); ++target) {
+        size_t position = Find(next[target].id);
+        if (position != LISTVIEWMODEL_NO_POSITION) {
+            targets[position] = static_cast<uint32_t>(target);
+        }
+    }
+
+    MarkStable(targets);
+
+    placed.assign(next.size(), ROW_INSERTED);
+    for (size_t position = rows.size(); position-- > 0;) {
+        uint32_t target = targets[position];
+        if (target != LISTVIEWMODEL_NO_POSITION && stable[position]) {
+            placed[target] = rows[position].stamp == next[target].stamp ? ROW_UNCHANGED : ROW_UPDATED;
+            continue;
+        }
+
+        bool moved = target != LISTVIEWMODEL_NO_POSITION;
+        if (moved) placed[target] = ROW_MOVED;
+        changes.push_back({ LIST_CHANGE_REMOVE, position, rows[position].id, moved });
+    }
+
+    for (size_t target = 0; target < next.size(); ++target) {
+        uint8_t state = placed[target];
+        if (state == ROW_INSERTED || state == ROW_MOVED) {
+            changes.push_back({ LIST_CHANGE_INSERT, target, next[target].id, state == ROW_MOVED });
+        }
+    }
+
+    for (size_t target = 0; target < next.size(); ++target) {
+        switch (placed[target]) {
+        case ROW_INSERTED: lastStats.inserted++; break;
+        case ROW_MOVED: lastStats.moved++; break;
+        case ROW_UPDATED:
+            changes.push_back({ LIST_CHANGE_UPDATE, target, next[target].id, false });
+            lastStats.updated++;
+            break;
+        default: lastStats.unchanged++; break;
+        }
+    }
+    lastStats.removed = rows.size() - lastStats.moved - lastStats.updated - lastStats.unchanged;
+
+    for (const ListRow& row : rows) {
+        slotPositions[row.id.index] = LISTVIEWMODEL_NO_POSITION;
+    }
+
+    rows = next;
+    for (size_t position = 0; position < rows.size(); ++position) {
+        uint32_t index = rows[position].id.index;
+        if (index >= slotPositions.size()) {
+            slotPositions.resize(index + 1, LISTVIEWMODEL_NO_POSITION);
+        }
+        slotPositions[index] = static_cast<uint32_t>(position);
+    }
+}
+
+void ServerListViewModel::MarkStable(const std::vector<uint32_t>& order) {
+    stable.assign(order.size(), 0);
+    tails.clear();
+    previous.assign(order.size(), LISTVIEWMODEL_NO_POSITION);
+
+    for (uint32_t position = 0; position < order.size(); ++position) {
+        uint32_t target = order[position];
+        if (target == LISTVIEWMODEL_NO_POSITION) continue;
+
+        auto slot = std::lower_bound(tails.begin(), tails.end(), target, [&order](uint32_t tail, uint32_t value) {
+            return order[tail] < value;
+            });
+        if (slot != tails.begin()) {
+            previous[position] = *(slot - 1);
+        }
+        if (slot == tails.end()) tails.push_back(position);
+        else *slot = position;
+    }
+
+    uint32_t position = tails.empty() ? LISTVIEWMODEL_NO_POSITION : tails.back();
+    while (position != LISTVIEWMODEL_NO_POSITION) {
+        stable[position] = 1;
+        position = previous[position];
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "ServerId.h"
+
+
+#define LISTVIEWMODEL_NO_POSITION   0xFFFFFFFFu
+
+
+enum ListChangeType {
+    LIST_CHANGE_REMOVE,
+    LIST_CHANGE_INSERT,
+    LIST_CHANGE_UPDATE
+};
+
+
+struct ListRow {
+    ServerId id;
+    uint64_t stamp = 0;
+};
+
+
+struct ListChange {
+    ListChangeType type;
+    size_t position;
+    ServerId id;
+    bool moved;
+};
+
+
+struct ListDiffStats {
+    size_t removed = 0;
+    size_t inserted = 0;
+    size_t moved = 0;
+    size_t updated = 0;
+    size_t unchanged = 0;
+};
+
+
+class ServerListViewModel {
+public:
+    void Reset();
+    void Diff(const std::vector<ListRow>& next, std::vector<ListChange>& changes);
+
+    const std::vector<ListRow>& GetRows() const { return rows; }
+    size_t size() const { return rows.size(); }
+    ServerId GetId(size_t position) const { return position < rows.size() ? rows[position].id : ServerId(); }
+    size_t Find(ServerId id) const;
+    const ListDiffStats& GetLastStats() const { return lastStats; }
+
+private:
+    enum RowState : uint8_t {
+        ROW_INSERTED,
+        ROW_MOVED,
+        ROW_UPDATED,
+        ROW_UNCHANGED
+    };
+
+    void MarkStable(const std::vector<uint32_t>& targets);
+
+    std::vector<ListRow> rows;
+    std::vector<uint32_t> slotPositions;
+    std::vector<uint32_t> targets;
+    std::vector<uint8_t> stable;
+    std::vector<uint32_t> tails;
+    std::vector<uint32_t> previous;
+    std::vector<uint8_t> placed;
+    ListDiffStats lastStats;
+};
@@ -1,10 +1,34 @@
 #include "ServerQuery.h"
+#include "CancellationToken.h"
 #include <chrono>
 #include <iostream>
 #include <sstream>
 #include <algorithm> 
-
-ServerQueryManager::ServerQueryManager() : udpSocket(INVALID_SOCKET), initialized(false) {}
+#include <cstdarg>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+static const uint8_t A2S_INFO_REQUEST[] = {
+    0xFF, 0xFF, 0xFF, 0xFF,  // Header
+    A2S_INFO,                // Query type (0x54)
+    'S', 'o', 'u', 'r', 'c', 'e', ' ', 'E', 'n', 'g', 'i', 'n', 'e', ' ', 'Q', 'u', 'e', 'r', 'y', 0x00
+};
+
+static const uint8_t A2S_PLAYER_REQUEST[] = {
+    0xFF, 0xFF, 0xFF, 0xFF,
+    A2S_PLAYER,
+    0xFF, 0xFF, 0xFF, 0xFF
+};
+
+static const uint8_t A2S_RULES_REQUEST[] = {
+    0xFF, 0xFF, 0xFF, 0xFF,
+    A2S_RULES,
+    0xFF, 0xFF, 0xFF, 0xFF
+};
+
+ServerQueryManager::ServerQueryManager()
+    : udpSocket(INVALID_SOCKET), wakeSocket(INVALID_SOCKET), wakeAddr{}, initialized(false), flights(std::make_shared<QueryFlights>()) {}
 
 ServerQueryManager::~ServerQueryManager() {
     Cleanup();
@@ -27,11 +51,91 @@ bool ServerQueryManager::Initialize() {
     setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
     setsockopt(udpSocket, SOL_SOCKET, SO_SNDTIMEO, (char*)&timeout, sizeof(timeout));
 
+    if (!OpenWakeSocket()) {
+        LogError("Failed to open wake socket, cancellation will wait for query timeouts");
+    }
+
     initialized = true;
     return true;
 }
 
+bool ServerQueryManager::OpenWakeSocket() {
+    wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wakeSocket == INVALID_SOCKET) return false;
+
+    wakeAddr.sin_family = AF_INET;
+    wakeAddr.sin_port = 0;
+    wakeAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(wakeAddr);
+    u_long nonBlocking = 1;
+
+    if (bind(wakeSocket, (sockaddr*)&wakeAddr, sizeof(wakeAddr)) == SOCKET_ERROR ||
+        getsockname(wakeSocket, (sockaddr*)&wakeAddr, &addrLen) == SOCKET_ERROR ||
+        ioctlsocket(wakeSocket, FIONBIO, &nonBlocking) == SOCKET_ERROR) {
+        closesocket(wakeSocket);
+        wakeSocket = INVALID_SOCKET;
+        return false;
+    }
+    return true;
+}
+
+void ServerQueryManager::Interrupt() {
+    if (wakeSocket == INVALID_SOCKET) return;
+
+    char signal = 0;
+    sendto(wakeSocket, &signal, 1, 0, (sockaddr*)&wakeAddr, sizeof(wakeAddr));
+}
+
+int ServerQueryManager::ReceiveFrom(PacketBuffer& buffer, sockaddr_in& fromAddr, socklen_t& fromLen, DWORD timeoutMs) {
+    CancellationToken* cancel = CancellationToken::Current();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (true) {
+        if (cancel && cancel->IsCancelled()) {
+            WSASetLastError(WSAEINTR);
+            return SOCKET_ERROR;
+        }
+
+        long long remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            WSASetLastError(WSAETIMEDOUT);
+            return SOCKET_ERROR;
+        }
+
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(udpSocket, &readable);
+        SOCKET highest = udpSocket;
+        if (wakeSocket != INVALID_SOCKET) {
+            FD_SET(wakeSocket, &readable);
+            highest = (std::max)(highest, wakeSocket);
+        }
+
+        timeval timeout;
+        timeout.tv_sec = static_cast<long>(remaining / 1000000);
+        timeout.tv_usec = static_cast<long>(remaining % 1000000);
+
+        int ready = select(static_cast<int>(highest + 1), &readable, nullptr, nullptr, &timeout);
+        if (ready == SOCKET_ERROR) return SOCKET_ERROR;
+
+        if (wakeSocket != INVALID_SOCKET && FD_ISSET(wakeSocket, &readable)) {
+            char signal[16];
+            while (recv(wakeSocket, signal, sizeof(signal), 0) > 0) {
+            }
+        }
+
+        if (FD_ISSET(udpSocket, &readable)) {
+            return recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
+                (sockaddr*)&fromAddr, &fromLen);
+        }
+    }
+}
+
 void ServerQueryManager::Cleanup() {
+    if (wakeSocket != INVALID_SOCKET) {
+        closesocket(wakeSocket);
+        wakeSocket = INVALID_SOCKET;
+    }
     if (udpSocket != INVALID_SOCKET) {
         closesocket(udpSocket);
         udpSocket = INVALID_SOCKET;
@@ -43,6 +147,40 @@ void ServerQueryManager::Cleanup() {
 }
 
 bool ServerQueryManager::QueryServerInfo(const std::string& ip, int port, A2SInfoResponse& response) {
+    uint64_t address = ServerUtils::PackAddress(ip, port);
+    if (!address) return FetchServerInfo(ip, port, response);
+
+    response = A2SInfoResponse{};
+    return flights->info.Run(address, response, [&](A2SInfoResponse& fresh) { return FetchServerInfo(ip, port, fresh); });
+}
+
+bool ServerQueryManager::QueryPlayerList(const std::string& ip, int port, A2SPlayerResponse& response) {
+    uint64_t address = ServerUtils::PackAddress(ip, port);
+    if (!address) return FetchPlayerList(ip, port, response);
+
+    response = A2SPlayerResponse{};
+    return flights->players.Run(address, response, [&](A2SPlayerResponse& fresh) { return FetchPlayerList(ip, port, fresh); });
+}
+
+bool ServerQueryManager::QueryServerRules(const std::string& ip, int port, A2SRulesResponse& response) {
+    uint64_t address = ServerUtils::PackAddress(ip, port);
+    if (!address) return FetchServerRules(ip, port, response);
+
+    response = A2SRulesResponse{};
+    return flights->rules.Run(address, response, [&](A2SRulesResponse& fresh) { return FetchServerRules(ip, port, fresh); });
+}
+
+SingleFlightStats QueryFlights::GetStats() const {
+    SingleFlightStats total;
+    for (const SingleFlightStats& stats : { info.GetStats(), players.GetStats(), rules.GetStats() }) {
+        total.sent += stats.sent;
+        total.joined += stats.joined;
+        total.cached += stats.cached;
+    }
+    return total;
+}
+
+bool ServerQueryManager::FetchServerInfo(const std::string& ip, int port, A2SInfoResponse& response) {
     if (!initialized) return false;
 
     response = A2SInfoResponse{};
@@ -51,36 +189,26 @@ bool ServerQueryManager::QueryServerInfo(const std::string& ip, int port, A2SInf
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_port = htons(port);
     if (inet_pton(AF_INET, ip.c_str(), &serverAddr.sin_addr) != 1) {
-        LogError("Invalid IP address: " + ip);
+        LogErrorFormat("Invalid IP address: %s", ip.c_str());
         return false;
     }
 
-    std::vector<uint8_t> initialQuery = {
-        0xFF, 0xFF, 0xFF, 0xFF,  // Header
-        A2S_INFO,                // Query type (0x54)
-        'S', 'o', 'u', 'r', 'c', 'e', ' ', 'E', 'n', 'g', 'i', 'n', 'e', ' ', 'Q', 'u', 'e', 'r', 'y', 0x00
-    };
 
-
-    if (sendto(udpSocket, (char*)initialQuery.data(), static_cast<int>(initialQuery.size()), 0,
+    if (sendto(udpSocket, (const char*)A2S_INFO_REQUEST, static_cast<int>(sizeof(A2S_INFO_REQUEST)), 0,
         (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-        LogError("Failed to send initial query to " + ip + ":" + std::to_string(port));
+        LogErrorFormat("Failed to send initial query to %s:%d", ip.c_str(), port);
         return false;
     }
 
 
-    std::vector<uint8_t> buffer(1400);
+    PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
     sockaddr_in fromAddr;
-    int fromLen = sizeof(fromAddr);
-
-    DWORD timeout = 5000;
-    setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
+    socklen_t fromLen = sizeof(fromAddr);
 
-    int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-        (sockaddr*)&fromAddr, &fromLen);
+    int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 5000);
 
     if (bytesReceived <= 0) {
-        LogError("No response from " + ip + ":" + std::to_string(port));
+        LogErrorFormat("No response from %s:%d", ip.c_str(), port);
         return false;
     }
 
@@ -91,36 +219,26 @@ bool ServerQueryManager::QueryServerInfo(const std::string& ip, int port, A2SInf
         buffer[0] == 0xFF && buffer[1] == 0xFF && buffer[2] == 0xFF && buffer[3] == 0xFF &&
         buffer[4] == 0x41) { // 0x41 = A2S_INFO_CHALLENGE
 
-        LogError("Received challenge response from " + ip + ":" + std::to_string(port));
-
+        LogErrorFormat("Received challenge response from %s:%d", ip.c_str(), port);
 
-        uint32_t challenge = *reinterpret_cast<const uint32_t*>(&buffer[5]);
 
-
-        std::vector<uint8_t> challengeQuery = {
-            0xFF, 0xFF, 0xFF, 0xFF,  // Header
-            A2S_INFO,                // Query type (0x54)
-            'S', 'o', 'u', 'r', 'c', 'e', ' ', 'E', 'n', 'g', 'i', 'n', 'e', ' ', 'Q', 'u', 'e', 'r', 'y', 0x00
-        };
+        uint8_t challengeQuery[sizeof(A2S_INFO_REQUEST) + 4];
+        memcpy(challengeQuery, A2S_INFO_REQUEST, sizeof(A2S_INFO_REQUEST));
+        memcpy(challengeQuery + sizeof(A2S_INFO_REQUEST), &buffer[5], 4);
 
 
-        challengeQuery.insert(challengeQuery.end(),
-            reinterpret_cast<const uint8_t*>(&challenge),
-            reinterpret_cast<const uint8_t*>(&challenge) + sizeof(challenge));
-
-
-        if (sendto(udpSocket, (char*)challengeQuery.data(), static_cast<int>(challengeQuery.size()), 0,
+        if (sendto(udpSocket, (const char*)challengeQuery, static_cast<int>(sizeof(challengeQuery)), 0,
             (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-            LogError("Failed to send challenge query to " + ip + ":" + std::to_string(port));
+            LogErrorFormat("Failed to send challenge query to %s:%d", ip.c_str(), port);
             return false;
         }
 
 
-        bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-            (sockaddr*)&fromAddr, &fromLen);
+        buffer.resize(A2S_PACKET_SIZE);
+        bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 5000);
 
         if (bytesReceived <= 0) {
-            LogError("No response to challenge query from " + ip + ":" + std::to_string(port));
+            LogErrorFormat("No response to challenge query from %s:%d", ip.c_str(), port);
             return false;
         }
 
@@ -136,22 +254,22 @@ bool ServerQueryManager::QueryServerInfo(const std::string& ip, int port, A2SInf
         ParseA2SInfo(buffer, response);
 
         if (!response.name.empty() && response.name != "Parse Error") {
-            LogError("Successfully queried " + ip + ":" + std::to_string(port) + " - " + response.name);
+            LogErrorFormat("Successfully queried %s:%d - %s", ip.c_str(), port, response.name.c_str());
             return true;
         }
     }
 
-    LogError("Invalid or corrupted response from " + ip + ":" + std::to_string(port));
+    LogErrorFormat("Invalid or corrupted response from %s:%d", ip.c_str(), port);
     return false;
 }
 
 
 
-void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoResponse& response) {
+void ServerQueryManager::ParseA2SInfo(const PacketBuffer& data, A2SInfoResponse& response) {
     response = A2SInfoResponse{};
 
     if (data.size() < 10) {
-        LogError("A2S response too short: " + std::to_string(data.size()) + " bytes");
+        LogErrorFormat("A2S response too short: %d bytes", static_cast<int>(data.size()));
         return;
     }
 
@@ -169,7 +287,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
     if (offset >= data.size()) return;
     uint8_t responseType = data[offset++];
     if (responseType != 0x49) {
-        LogError("Invalid A2S response type: " + std::to_string(responseType) + " (expected 0x49)");
+        LogErrorFormat("Invalid A2S response type: %d (expected 0x49)", responseType);
         return;
     }
 
@@ -181,12 +299,12 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
 
         response.name = ReadNullTerminatedString(data, offset);
         if (response.name.empty() && offset < data.size()) {
-            LogError("Failed to read server name at offset " + std::to_string(offset));
+            LogErrorFormat("Failed to read server name at offset %d", static_cast<int>(offset));
             return;
         }
 
 
-        std::string cleanName = response.name;
+        std::string& cleanName = response.name;
         for (char& c : cleanName) {
             if (c < 32 || c > 126) c = ' ';
         }
@@ -196,31 +314,28 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         cleanName.erase(cleanName.find_last_not_of(" \t\r\n") + 1);
 
         if (cleanName.empty() || cleanName.length() > 200) {
-            LogError("Invalid server name: '" + response.name + "'");
+            LogErrorFormat("Invalid server name: '%s'", cleanName.c_str());
             response.name = "Invalid Server Name";
         }
-        else {
-            response.name = cleanName;
-        }
 
-        response.map = ReadNullTerminatedString(data, offset);
+        response.map = ReadInternedString(data, offset);
         if (response.map.empty()) {
             response.map = "Unknown";
         }
 
 
-        response.folder = ReadNullTerminatedString(data, offset);
+        response.folder = ReadInternedString(data, offset);
         if (response.folder.empty()) {
             response.folder = "dayz";
         }
 
 
-        response.game = ReadNullTerminatedString(data, offset);
+        response.game = ReadInternedString(data, offset);
 
 
         if (offset + 8 > data.size()) {
-            LogError("Not enough data for remaining fields. Offset: " + std::to_string(offset) +
-                ", Size: " + std::to_string(data.size()));
+            LogErrorFormat("Not enough data for remaining fields. Offset: %d, Size: %d",
+                static_cast<int>(offset), static_cast<int>(data.size()));
             return;
         }
 
@@ -238,7 +353,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         response.vac = ReadUint8(data, offset);
 
 
-        response.version = ReadNullTerminatedString(data, offset);
+        response.version = ReadInternedString(data, offset);
         if (response.version.empty()) {
             response.version = "1.28";
         }
@@ -262,7 +377,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
 
 
             if (response.maxPlayers > 200 || response.maxPlayers < 1) {
-                LogError("Invalid maxPlayers: " + std::to_string(response.maxPlayers));
+                LogErrorFormat("Invalid maxPlayers: %d", response.maxPlayers);
                 response.maxPlayers = 60;
             }
 
@@ -270,8 +385,8 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
                 response.players = response.maxPlayers;
             }
 
-            LogError("Successfully parsed server: " + response.name + " (" +
-                std::to_string(response.players) + "/" + std::to_string(response.maxPlayers) + ")");
+            LogErrorFormat("Successfully parsed server: %s (%d/%d)",
+                response.name.c_str(), response.players, response.maxPlayers);
 
         }
         catch (const std::exception& e) {
@@ -295,7 +410,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         auto start = std::chrono::high_resolution_clock::now();
 
         A2SInfoResponse response;
-        bool success = QueryServerInfo(ip, port, response);
+        bool success = FetchServerInfo(ip, port, response);
 
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
@@ -336,7 +451,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             LogError("=== BATCH " + std::to_string(batchCount) + " starting from: " + startAddr + " ===");
 
 
-            std::vector<uint8_t> query;
+            PacketBuffer query(ScanArena::Current());
             query.push_back(0x31);
             query.push_back(0xFF);
 
@@ -359,15 +474,11 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             }
 
 
-            std::vector<uint8_t> buffer(1400);
+            PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
             sockaddr_in fromAddr;
-            int fromLen = sizeof(fromAddr);
+            socklen_t fromLen = sizeof(fromAddr);
 
-            DWORD timeout = 15000;
-            setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-
-            int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-                (sockaddr*)&fromAddr, &fromLen);
+            int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 15000);
 
             if (bytesReceived <= 0) {
                 LogError("No response for batch " + std::to_string(batchCount));
@@ -432,14 +543,11 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             currentStartIP = lastServerIP;
             currentStartPort = lastServerPort + 1;
 
-            Sleep(1000);
+            if (CancellationToken::WaitCurrent(1000)) break;
         }
 
     pagination_complete:
 
-        DWORD timeout = 5000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-
         LogError("=== PAGINATION COMPLETE: " + std::to_string(totalServers) + " servers in " + std::to_string(batchCount) + " batches ===");
         return !servers.empty();
     }
@@ -463,7 +571,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         memcpy(&masterAddr.sin_addr, host->h_addr_list[0], host->h_length);
 
 
-        std::vector<uint8_t> query;
+        PacketBuffer query(ScanArena::Current());
         query.push_back(0x31);
         query.push_back(0xFF);
 
@@ -483,18 +591,11 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             return false;
         }
 
-        std::vector<uint8_t> buffer(1400);
+        PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
         sockaddr_in fromAddr;
-        int fromLen = sizeof(fromAddr);
-
-        DWORD timeout = 10000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-
-        int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-            (sockaddr*)&fromAddr, &fromLen);
+        socklen_t fromLen = sizeof(fromAddr);
 
-        timeout = 5000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
+        int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 10000);
 
         if (bytesReceived <= 0) return false;
 
@@ -553,7 +654,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         masterAddr.sin_port = htons(masterPort);
         memcpy(&masterAddr.sin_addr, host->h_addr_list[0], host->h_length);
 
-        std::vector<uint8_t> query;
+        PacketBuffer query(ScanArena::Current());
         query.push_back(0x31);
         query.push_back(0xFF);
         for (char c : startAddr) {
@@ -574,19 +675,11 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             return false;
         }
 
-        std::vector<uint8_t> buffer(1400);
+        PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
         sockaddr_in fromAddr;
-        int fromLen = sizeof(fromAddr);
-
-        DWORD timeout = 10000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-
-        int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-            (sockaddr*)&fromAddr, &fromLen);
-
+        socklen_t fromLen = sizeof(fromAddr);
 
-        timeout = 5000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
+        int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 10000);
 
         if (bytesReceived <= 0) return false;
 
@@ -664,7 +757,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
                 LogError("Start point " + startPoint + " returned: " + std::to_string(batchServers.size()) + " servers");
                 allServers.insert(allServers.end(), batchServers.begin(), batchServers.end());
             }
-            Sleep(2000);
+            if (CancellationToken::WaitCurrent(2000)) break;
         }
 
 
@@ -705,7 +798,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             }
 
 
-            std::vector<uint8_t> query;
+            PacketBuffer query(ScanArena::Current());
             query.push_back(0x31);
             query.push_back(0xFF);
 
@@ -731,14 +824,10 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             }
 
 
-            std::vector<uint8_t> buffer(1400);
-            DWORD timeout = 10000;
-            setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-
+            PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
             sockaddr_in fromAddr;
-            int fromLen = sizeof(fromAddr);
-            int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-                (sockaddr*)&fromAddr, &fromLen);
+            socklen_t fromLen = sizeof(fromAddr);
+            int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 10000);
 
             if (bytesReceived > 6) {
                 buffer.resize(bytesReceived);
@@ -808,7 +897,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
 
 
-        std::vector<uint8_t> query;
+        PacketBuffer query(ScanArena::Current());
         query.push_back(0x31); // A2M_GET_SERVERS_BATCH2
         query.push_back(0xFF); // All regions
 
@@ -825,18 +914,11 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
 
 
-        std::vector<uint8_t> buffer(1400);
+        PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
         sockaddr_in fromAddr;
-        int fromLen = sizeof(fromAddr);
-
-        DWORD timeout = 8000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-
-        int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-            (sockaddr*)&fromAddr, &fromLen);
+        socklen_t fromLen = sizeof(fromAddr);
 
-        timeout = 5000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
+        int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 8000);
 
         if (bytesReceived <= 0) return false;
 
@@ -857,6 +939,27 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
 #endif
     }
 
+    void ServerQueryManager::LogErrorFormat(const char* format, ...) {
+        char message[512];
+        int length = snprintf(message, sizeof(message), "ServerQuery: ");
+
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(message + length, sizeof(message) - length - 1, format, args);
+        va_end(args);
+
+        if (written < 0) written = 0;
+        length = (std::min)(length + written, static_cast<int>(sizeof(message)) - 2);
+        message[length] = '\n';
+        message[length + 1] = '\0';
+        OutputDebugStringA(message);
+
+
+#ifdef _DEBUG
+        std::cout << message;
+#endif
+    }
+
     bool ServerQueryManager::QueryAllRegions(std::vector<std::pair<std::string, int>>&servers) {
         if (!initialized) return false;
 
@@ -888,7 +991,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             }
 
 
-            Sleep(2000);
+            if (CancellationToken::WaitCurrent(2000)) break;
         }
 
         std::sort(allServers.begin(), allServers.end());
@@ -911,7 +1014,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         inet_pton(AF_INET, masterIP, &masterAddr.sin_addr);
 
 
-        std::vector<uint8_t> query;
+        PacketBuffer query(ScanArena::Current());
         query.push_back(0x31);
         query.push_back(region);
         for (int i = 0; i < 6; i++) {
@@ -928,12 +1031,11 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             return false;
         }
 
-        std::vector<uint8_t> buffer(1400);
+        PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
         sockaddr_in fromAddr;
-        int fromLen = sizeof(fromAddr);
+        socklen_t fromLen = sizeof(fromAddr);
 
-        int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-            (sockaddr*)&fromAddr, &fromLen);
+        int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 5000);
 
         if (bytesReceived <= 0) return false;
 
@@ -947,7 +1049,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
 
 
     bool ServerQueryManager::SendQuery(const std::string & ip, int port, const ServerQuery & query,
-        std::vector<uint8_t>&response, int timeoutMs) {
+        PacketBuffer& response, int timeoutMs) {
         if (!initialized) return false;
 
         sockaddr_in serverAddr;
@@ -962,12 +1064,11 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
 
 
-        response.resize(1400);
+        response.resize(A2S_PACKET_SIZE);
         sockaddr_in fromAddr;
-        int fromLen = sizeof(fromAddr);
+        socklen_t fromLen = sizeof(fromAddr);
 
-        int bytesReceived = recvfrom(udpSocket, (char*)response.data(), static_cast<int>(response.size()), 0,
-            (sockaddr*)&fromAddr, &fromLen);
+        int bytesReceived = ReceiveFrom(response, fromAddr, fromLen, timeoutMs);
 
         if (bytesReceived <= 0) return false;
 
@@ -976,7 +1077,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
     }
 
     bool ServerQueryManager::SendQueryWithChallenge(const std::string & ip, int port, const ServerQuery & query,
-        std::vector<uint8_t>&response, int timeoutMs) {
+        PacketBuffer& response, int timeoutMs) {
 
         uint32_t challenge;
         if (!GetChallenge(ip, port, challenge)) {
@@ -984,7 +1085,8 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
 
 
-        std::vector<uint8_t> challengeQuery;
+        PacketBuffer challengeQuery(ScanArena::Current());
+        challengeQuery.reserve(query.payloadSize + sizeof(challenge));
         challengeQuery.insert(challengeQuery.end(),
             reinterpret_cast<const uint8_t*>(query.payload),
             reinterpret_cast<const uint8_t*>(query.payload) + query.payloadSize);
@@ -1001,10 +1103,16 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         return SendQuery(ip, port, challengeQueryStruct, response, timeoutMs);
     }
 
-    std::string ServerQueryManager::ReadNullTerminatedString(const std::vector<uint8_t>&data, size_t & offset) {
+    std::string ServerQueryManager::ReadNullTerminatedString(const PacketBuffer& data, size_t & offset) {
         std::string result;
 
         try {
+            size_t end = offset;
+            while (end < data.size() && data[end] != 0 && end - offset <= 512) {
+                end++;
+            }
+            result.reserve(end - offset + 1);
+
             while (offset < data.size() && data[offset] != 0) {
                 char c = static_cast<char>(data[offset]);
 
@@ -1043,16 +1151,35 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         return result;
     }
 
+    InternedString ServerQueryManager::ReadInternedString(const PacketBuffer& data, size_t & offset) {
+        size_t end = offset;
+        bool clean = true;
+        while (end < data.size() && data[end] != 0) {
+            if (data[end] < 32 || data[end] > 126) clean = false;
+            end++;
+        }
 
+        size_t length = end - offset;
+        if (clean && length <= 512 &&
+            (length == 0 || (data[offset] != ' ' && data[end - 1] != ' '))) {
+            std::string_view text(reinterpret_cast<const char*>(data.data()) + offset, length);
+            offset = end < data.size() ? end + 1 : end;
+            return InternedString(text);
+        }
 
-    uint8_t ServerQueryManager::ReadUint8(const std::vector<uint8_t>&data, size_t & offset) {
+        return InternedString(ReadNullTerminatedString(data, offset));
+    }
+
+
+
+    uint8_t ServerQueryManager::ReadUint8(const PacketBuffer& data, size_t & offset) {
         if (offset < data.size()) {
             return data[offset++];
         }
         return 0;
     }
 
-    uint16_t ServerQueryManager::ReadUint16(const std::vector<uint8_t>&data, size_t & offset) {
+    uint16_t ServerQueryManager::ReadUint16(const PacketBuffer& data, size_t & offset) {
         if (offset + 1 < data.size()) {
             uint16_t value = *reinterpret_cast<const uint16_t*>(&data[offset]);
             offset += 2;
@@ -1061,7 +1188,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         return 0;
     }
 
-    uint32_t ServerQueryManager::ReadUint32(const std::vector<uint8_t>&data, size_t & offset) {
+    uint32_t ServerQueryManager::ReadUint32(const PacketBuffer& data, size_t & offset) {
         if (offset + 3 < data.size()) {
             uint32_t value = *reinterpret_cast<const uint32_t*>(&data[offset]);
             offset += 4;
@@ -1070,7 +1197,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         return 0;
     }
 
-    uint64_t ServerQueryManager::ReadUint64(const std::vector<uint8_t>&data, size_t & offset) {
+    uint64_t ServerQueryManager::ReadUint64(const PacketBuffer& data, size_t & offset) {
         if (offset + 7 < data.size()) {
             uint64_t value = *reinterpret_cast<const uint64_t*>(&data[offset]);
             offset += 8;
@@ -1079,7 +1206,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         return 0;
     }
 
-    float ServerQueryManager::ReadFloat(const std::vector<uint8_t>&data, size_t & offset) {
+    float ServerQueryManager::ReadFloat(const PacketBuffer& data, size_t & offset) {
         if (offset + 3 < data.size()) {
             float value = *reinterpret_cast<const float*>(&data[offset]);
             offset += 4;
@@ -1090,7 +1217,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
 
 
 
-    bool ServerQueryManager::IsValidResponse(const std::vector<uint8_t>&data, uint8_t expectedType) {
+    bool ServerQueryManager::IsValidResponse(const PacketBuffer& data, uint8_t expectedType) {
         return data.size() >= 5 && data[4] == expectedType;
     }
 
@@ -1126,21 +1253,15 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
 
 
 
-    bool ServerQueryManager::QueryPlayerList(const std::string & ip, int port, A2SPlayerResponse & response) {
+    bool ServerQueryManager::FetchPlayerList(const std::string & ip, int port, A2SPlayerResponse & response) {
 
         if (!initialized) return false;
 
-        std::vector<uint8_t> query = {
-            0xFF, 0xFF, 0xFF, 0xFF,
-            A2S_PLAYER,
-            0xFF, 0xFF, 0xFF, 0xFF
-        };
-
-        std::vector<uint8_t> responseData;
+        PacketBuffer responseData(ScanArena::Current());
         ServerQuery playerQuery;
         playerQuery.header = A2S_PLAYER;
-        playerQuery.payload = reinterpret_cast<const char*>(query.data());
-        playerQuery.payloadSize = query.size();
+        playerQuery.payload = reinterpret_cast<const char*>(A2S_PLAYER_REQUEST);
+        playerQuery.payloadSize = sizeof(A2S_PLAYER_REQUEST);
 
         if (SendQuery(ip, port, playerQuery, responseData)) {
             ParseA2SPlayer(responseData, response);
@@ -1151,7 +1272,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
     }
 
 
-    bool ServerQueryManager::QueryServerRules(const std::string & ip, int port, A2SRulesResponse & response) {
+    bool ServerQueryManager::FetchServerRules(const std::string & ip, int port, A2SRulesResponse & response) {
         if (!initialized) return false;
 
         response = A2SRulesResponse{};
@@ -1164,26 +1285,16 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
 
 
-        std::vector<uint8_t> initialQuery = {
-            0xFF, 0xFF, 0xFF, 0xFF,
-            A2S_RULES,
-            0xFF, 0xFF, 0xFF, 0xFF
-        };
-
-        if (sendto(udpSocket, (char*)initialQuery.data(), static_cast<int>(initialQuery.size()), 0,
+        if (sendto(udpSocket, (const char*)A2S_RULES_REQUEST, static_cast<int>(sizeof(A2S_RULES_REQUEST)), 0,
             (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
             return false;
         }
 
-        std::vector<uint8_t> buffer(1400);
+        PacketBuffer buffer(A2S_PACKET_SIZE, ScanArena::Current());
         sockaddr_in fromAddr;
-        int fromLen = sizeof(fromAddr);
+        socklen_t fromLen = sizeof(fromAddr);
 
-        DWORD timeout = 5000;
-        setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-
-        int bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-            (sockaddr*)&fromAddr, &fromLen);
+        int bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 5000);
 
         if (bytesReceived <= 0) return false;
 
@@ -1195,25 +1306,18 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             buffer[4] == 0x41) {
 
 
-            uint32_t challenge = *reinterpret_cast<const uint32_t*>(&buffer[5]);
-
-            std::vector<uint8_t> challengeQuery = {
-                0xFF, 0xFF, 0xFF, 0xFF,
-                A2S_RULES
-            };
-
-            challengeQuery.insert(challengeQuery.end(),
-                reinterpret_cast<const uint8_t*>(&challenge),
-                reinterpret_cast<const uint8_t*>(&challenge) + sizeof(challenge));
+            uint8_t challengeQuery[sizeof(A2S_RULES_REQUEST)];
+            memcpy(challengeQuery, A2S_RULES_REQUEST, 5);
+            memcpy(challengeQuery + 5, &buffer[5], 4);
 
-            if (sendto(udpSocket, (char*)challengeQuery.data(), static_cast<int>(challengeQuery.size()), 0,
+            if (sendto(udpSocket, (const char*)challengeQuery, static_cast<int>(sizeof(challengeQuery)), 0,
                 (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
                 return false;
             }
 
 
-            bytesReceived = recvfrom(udpSocket, (char*)buffer.data(), static_cast<int>(buffer.size()), 0,
-                (sockaddr*)&fromAddr, &fromLen);
+            buffer.resize(A2S_PACKET_SIZE);
+            bytesReceived = ReceiveFrom(buffer, fromAddr, fromLen, 5000);
 
             if (bytesReceived <= 0) return false;
             buffer.resize(bytesReceived);
@@ -1256,6 +1360,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             info.version = infoResponse.version;
             info.hasVAC = (infoResponse.vac == 1);
             info.isPassworded = (infoResponse.visibility == 1);
+            info.isFirstPerson = ServerUtils::IsFirstPersonServer(info.name, infoResponse.keywords);
             info.folder = infoResponse.folder;
             info.ping = PingServer(ip, port);
             info.lastUpdated = time(nullptr);
@@ -1283,6 +1388,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             info.version = response.version;
             info.hasVAC = (response.vac == 1);
             info.isPassworded = (response.visibility == 1);
+            info.isFirstPerson = ServerUtils::IsFirstPersonServer(info.name, response.keywords);
             info.ping = PingServer(ip, port);
             info.isOfficial = (info.name.find("Official") != std::string::npos);
             info.lastUpdated = time(nullptr);
@@ -1321,7 +1427,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         return lanServers;
     }
 
-    void ServerQueryManager::ParseA2SPlayer(const std::vector<uint8_t>&data, A2SPlayerResponse & response) {
+    void ServerQueryManager::ParseA2SPlayer(const PacketBuffer& data, A2SPlayerResponse & response) {
         if (data.size() < 6) return;
 
         size_t offset = 5;
@@ -1340,7 +1446,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
     }
 
-    void ServerQueryManager::ParseA2SRules(const std::vector<uint8_t>&data, A2SRulesResponse & response) {
+    void ServerQueryManager::ParseA2SRules(const PacketBuffer& data, A2SRulesResponse & response) {
         response = A2SRulesResponse{};
 
         if (data.size() < 7) {
@@ -1379,7 +1485,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
     }
 
 
-    void ServerQueryManager::ParseMasterServerResponse(const std::vector<uint8_t>&data,
+    void ServerQueryManager::ParseMasterServerResponse(const PacketBuffer& data,
         std::vector<std::pair<std::string, int>>&servers) {
         if (data.size() < 6) return;
 
@@ -1413,13 +1519,63 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
     }
 
+    std::shared_ptr<const ServerDetails> ServerDetails::Intern(const InternedString& gameMode, const InternedString& country) {
+        static std::mutex tableMutex;
+        static std::unordered_map<uint64_t, std::shared_ptr<const ServerDetails>> table;
+
+        uint64_t key = (static_cast<uint64_t>(gameMode.id()) << 32) | country.id();
+
+        std::lock_guard<std::mutex> lock(tableMutex);
+        auto& entry = table[key];
+        if (!entry) {
+            auto details = std::make_shared<ServerDetails>();
+            details->gameMode = gameMode;
+            details->country = country;
+            entry = std::move(details);
+        }
+        return entry;
+    }
+
+    const std::string& ServerInfo::getGameMode() const {
+        return details ? details->gameMode.str() : InternedString().str();
+    }
+
+    const std::string& ServerInfo::getCountry() const {
+        return details ? details->country.str() : InternedString().str();
+    }
+
+    void ServerInfo::setDetails(const InternedString& gameMode, const InternedString& country) {
+        if (gameMode.empty() && country.empty()) {
+            details.reset();
+        }
+        else {
+            details = ServerDetails::Intern(gameMode, country);
+        }
+    }
+
+    size_t ServerInfo::getMemoryUsage() const {
+        static const size_t inlineCapacity = std::string().capacity();
+        auto heapBytes = [](const std::string& text) -> size_t {
+            return text.capacity() > inlineCapacity ? text.capacity() + 1 : 0;
+            };
+
+        size_t total = sizeof(ServerInfo) + heapBytes(name) + heapBytes(ip);
+        if (mods) {
+            total += (sizeof(ModSet) + mods->size() * sizeof(WorkshopId)) / static_cast<size_t>(mods.use_count());
+        }
+        if (details) {
+            total += sizeof(ServerDetails) / static_cast<size_t>(details.use_count());
+        }
+        return total;
+    }
+
     std::string ServerInfo::toJson() const {
         std::ostringstream json;
         json << "{"
             << "\"name\":\"" << name << "\","
             << "\"ip\":\"" << ip << "\","
             << "\"port\":" << port << ","
-            << "\"map\":\"" << map << "\","
+            << "\"map\":\"" << map.str() << "\","
             << "\"players\":" << players << ","
             << "\"maxPlayers\":" << maxPlayers << ","
             << "\"ping\":" << ping << ","
@@ -1427,9 +1583,10 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             << "\"isFavorite\":" << (isFavorite ? "true" : "false") << ","
             << "\"isPassworded\":" << (isPassworded ? "true" : "false") << ","
             << "\"hasVAC\":" << (hasVAC ? "true" : "false") << ","
-            << "\"version\":\"" << version << "\","
-            << "\"gameMode\":\"" << gameMode << "\","
-            << "\"folder\":\"" << folder << "\","
+            << "\"isFirstPerson\":" << (isFirstPerson ? "true" : "false") << ","
+            << "\"version\":\"" << version.str() << "\","
+            << "\"gameMode\":\"" << getGameMode() << "\","
+            << "\"folder\":\"" << folder.str() << "\","
             << "\"lastUpdated\":" << lastUpdated
             << "}";
         return json.str();
@@ -1475,7 +1632,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         server.ip = findValue("ip");
         server.map = findValue("map");
         server.version = findValue("version");
-        server.gameMode = findValue("gameMode");
+        server.setDetails(findValue("gameMode"), "");
         server.folder = findValue("folder");
 
         server.port = findNumber("port");
@@ -1488,6 +1645,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         server.isFavorite = findBool("isFavorite");
         server.isPassworded = findBool("isPassworded");
         server.hasVAC = findBool("hasVAC");
+        server.isFirstPerson = findBool("isFirstPerson");
 
         return server;
     }
@@ -1504,7 +1662,7 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
         }
 
         bool IsModdedServer(const ServerInfo& server) {
-            return !server.mods.empty() ||
+            return server.hasMods() ||
                 server.name.find("Modded") != std::string::npos ||
                 server.name.find("Custom") != std::string::npos ||
                 server.folder != "dayz";
@@ -1573,4 +1731,50 @@ void ServerQueryManager::ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoR
             if (ip.substr(0, 3) == "139") return "Canada";
             return "Unknown";
         }
+
+        uint64_t PackAddress(const std::string& ip, int port) {
+            if (port <= 0 || port > 0xFFFF) return 0;
+
+            uint32_t address = 0;
+            uint32_t octet = 0;
+            int digits = 0;
+            int dots = 0;
+            for (char c : ip) {
+                if (c >= '0' && c <= '9') {
+                    octet = octet * 10 + static_cast<uint32_t>(c - '0');
+                    if (++digits > 3 || octet > 255) return 0;
+                }
+                else if (c == '.' && digits > 0 && dots < 3) {
+                    address = (address << 8) | octet;
+                    octet = 0;
+                    digits = 0;
+                    dots++;
+                }
+                else {
+                    return 0;
+                }
+            }
+            if (dots != 3 || digits == 0) return 0;
+
+            address = (address << 8) | octet;
+            return (static_cast<uint64_t>(address) << 16) | static_cast<uint64_t>(port);
+        }
+
+        bool IsFirstPersonServer(const std::string& name, const std::string& keywords) {
+            if (keywords.find("no3rd") != std::string::npos) return true;
+            return name.find("1PP") != std::string::npos ||
+                name.find("1pp") != std::string::npos ||
+                name.find("FPP") != std::string::npos;
+        }
+
+        bool IsLANAddress(const std::string& ip) {
+            uint64_t packed = PackAddress(ip, 1);
+            if (!packed) return false;
+
+            uint32_t address = static_cast<uint32_t>(packed >> 16);
+            return (address >> 24) == 10 ||
+                (address >> 24) == 127 ||
+                (address >> 16) == 0xC0A8 ||
+                (address >> 20) == 0xAC1;
+        }
     }
\ No newline at end of file
@@ -1,13 +1,16 @@
 #pragma once
 
-#include <windows.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
+#include "Platform.h"
 #include <vector>
 #include <string>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include "StringPool.h"
+#include "ScanArena.h"
+#include "ModSet.h"
+#include "SingleFlight.h"
 
 
 #define A2S_INFO            0x54
@@ -32,9 +35,9 @@ struct ServerQuery {
 struct A2SInfoResponse {
     uint8_t protocol;
     std::string name;
-    std::string map;
-    std::string folder;
-    std::string game;
+    InternedString map;
+    InternedString folder;
+    InternedString game;
     uint16_t id;
     uint8_t players;
     uint8_t maxPlayers;
@@ -43,7 +46,7 @@ struct A2SInfoResponse {
     uint8_t environment;
     uint8_t visibility;
     uint8_t vac;
-    std::string version;
+    InternedString version;
     uint8_t edf;
     uint16_t port;
     uint64_t steamId;
@@ -74,41 +77,41 @@ struct A2SRulesResponse {
 };
 
 
+struct ServerDetails {
+    InternedString gameMode;
+    InternedString country;
+
+    static std::shared_ptr<const ServerDetails> Intern(const InternedString& gameMode, const InternedString& country);
+};
+
+
 struct ServerInfo {
+    InternedString map;
+    InternedString version;
+    InternedString folder;
+    int32_t ping;
+    uint16_t port;
+    uint16_t players;
+    uint16_t maxPlayers;
+    bool isOfficial : 1;
+    bool isFavorite : 1;
+    bool isPassworded : 1;
+    bool hasVAC : 1;
+    bool isFirstPerson : 1;
+    bool isPlayed : 1;
+
     std::string name;
-    std::string map;
     std::string ip;
-    int port;
-    int players;
-    int maxPlayers;
-    int ping;
-    bool isOfficial;
-    bool isFavorite;
-    bool isPassworded;
-    bool hasVAC;
-    bool hasAntiCheat;
-    std::string gameMode;
-    std::string version;
-    std::string folder;
-    std::string timeOfDay;
-    std::string weather;
+    ModSetRef mods;
     time_t lastUpdated;
-    std::vector<std::string> tags;
-    std::vector<std::string> mods;
-
 
-    float tickRate;
-    int uptime;
 
-
-    std::string country;
-    std::string region;
+    std::shared_ptr<const ServerDetails> details;
 
  
-    ServerInfo() : port(0), players(0), maxPlayers(0), ping(-1),
+    ServerInfo() : ping(-1), port(0), players(0), maxPlayers(0),
         isOfficial(false), isFavorite(false), isPassworded(false),
-        hasVAC(false), hasAntiCheat(false), lastUpdated(0),
-        tickRate(0.0f), uptime(0) {
+        hasVAC(false), isFirstPerson(false), isPlayed(false), lastUpdated(0) {
     }
 
 
@@ -129,6 +132,16 @@ struct ServerInfo {
         return ip + ":" + std::to_string(port);
     }
 
+    const std::string& getGameMode() const;
+    const std::string& getCountry() const;
+    void setDetails(const InternedString& gameMode, const InternedString& country);
+
+    size_t getMemoryUsage() const;
+
+    bool hasMods() const {
+        return mods && !mods->empty();
+    }
+
     bool isOnline() const {
         return ping != -1;
     }
@@ -142,11 +155,26 @@ struct ServerInfo {
     }
 };
 
+struct QueryFlights {
+    SingleFlight<A2SInfoResponse> info;
+    SingleFlight<A2SPlayerResponse> players;
+    SingleFlight<A2SRulesResponse> rules;
+
+    SingleFlightStats GetStats() const;
+};
+
+typedef std::shared_ptr<QueryFlights> QueryFlightsRef;
+
 class ServerQueryManager {
+    friend class QueryEngine;
+
 private:
     SOCKET udpSocket;
+    SOCKET wakeSocket;
+    sockaddr_in wakeAddr;
     bool initialized;
     std::chrono::milliseconds defaultTimeout{ 5000 };
+    QueryFlightsRef flights;
 
 
 public:
@@ -163,11 +191,14 @@ public:
     std::vector<std::pair<std::string, int>> GetLANServers();
     bool Initialize();
     void Cleanup();
+    void Interrupt();
 
     bool QueryServerInfo(const std::string& ip, int port, A2SInfoResponse& response);
     bool QueryPlayerList(const std::string& ip, int port, A2SPlayerResponse& response);
     bool QueryServerRules(const std::string& ip, int port, A2SRulesResponse& response);
     int PingServer(const std::string& ip, int port);
+    SingleFlightStats GetQueryStats() const { return flights->GetStats(); }
+    void ShareFlights(QueryFlightsRef shared) { flights = std::move(shared); }
     bool QuerySingleBatch(const std::string& startAddr, std::vector<std::pair<std::string, int>>& servers);
 
  
@@ -191,30 +222,37 @@ public:
     std::vector<std::pair<std::string, int>> DiscoverLANServers();
 
 private:
+    bool FetchServerInfo(const std::string& ip, int port, A2SInfoResponse& response);
+    bool FetchPlayerList(const std::string& ip, int port, A2SPlayerResponse& response);
+    bool FetchServerRules(const std::string& ip, int port, A2SRulesResponse& response);
+    int ReceiveFrom(PacketBuffer& buffer, sockaddr_in& fromAddr, socklen_t& fromLen, DWORD timeoutMs);
+    bool OpenWakeSocket();
 
     bool SendQuery(const std::string& ip, int port, const ServerQuery& query,
-        std::vector<uint8_t>& response, int timeoutMs = 5000);
+        PacketBuffer& response, int timeoutMs = 5000);
     bool SendQueryWithChallenge(const std::string& ip, int port, const ServerQuery& query,
-        std::vector<uint8_t>& response, int timeoutMs = 5000);
+        PacketBuffer& response, int timeoutMs = 5000);
 
 
-    void ParseA2SInfo(const std::vector<uint8_t>& data, A2SInfoResponse& response);
-    void ParseA2SPlayer(const std::vector<uint8_t>& data, A2SPlayerResponse& response);
-    void ParseA2SRules(const std::vector<uint8_t>& data, A2SRulesResponse& response);
-    void ParseMasterServerResponse(const std::vector<uint8_t>& data,
+    void ParseA2SInfo(const PacketBuffer& data, A2SInfoResponse& response);
+    void ParseA2SPlayer(const PacketBuffer& data, A2SPlayerResponse& response);
+    void ParseA2SRules(const PacketBuffer& data, A2SRulesResponse& response);
+    void ParseMasterServerResponse(const PacketBuffer& data,
         std::vector<std::pair<std::string, int>>& servers);
 
 
-    std::string ReadNullTerminatedString(const std::vector<uint8_t>& data, size_t& offset);
-    uint8_t ReadUint8(const std::vector<uint8_t>& data, size_t& offset);
-    uint16_t ReadUint16(const std::vector<uint8_t>& data, size_t& offset);
-    uint32_t ReadUint32(const std::vector<uint8_t>& data, size_t& offset);
-    uint64_t ReadUint64(const std::vector<uint8_t>& data, size_t& offset);
-    float ReadFloat(const std::vector<uint8_t>& data, size_t& offset);
+    std::string ReadNullTerminatedString(const PacketBuffer& data, size_t& offset);
+    InternedString ReadInternedString(const PacketBuffer& data, size_t& offset);
+    uint8_t ReadUint8(const PacketBuffer& data, size_t& offset);
+    uint16_t ReadUint16(const PacketBuffer& data, size_t& offset);
+    uint32_t ReadUint32(const PacketBuffer& data, size_t& offset);
+    uint64_t ReadUint64(const PacketBuffer& data, size_t& offset);
+    float ReadFloat(const PacketBuffer& data, size_t& offset);
 
 
     void LogError(const std::string& message);
-    bool IsValidResponse(const std::vector<uint8_t>& data, uint8_t expectedType);
+    void LogErrorFormat(const char* format, ...);
+    bool IsValidResponse(const PacketBuffer& data, uint8_t expectedType);
 
 
     bool SetSocketTimeout(SOCKET sock, int timeoutMs);
@@ -236,4 +274,7 @@ namespace ServerUtils {
     std::string FormatLastSeen(time_t timestamp);
     std::vector<std::string> ParseServerTags(const std::string& tags);
     std::string GetCountryFromIP(const std::string& ip);
+    uint64_t PackAddress(const std::string& ip, int port);
+    bool IsLANAddress(const std::string& ip);
+    bool IsFirstPersonServer(const std::string& name, const std::string& keywords);
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "ServerSnapshot.h"
+#include "ServerStore.h"
+
+
+const ServerSnapshot::Entry* ServerSnapshot::Find(ServerId id) const {
+    if (!id.IsValid()) return nullptr;
+
+    size_t chunk = id.index / SERVERSNAPSHOT_CHUNK_SIZE;
+    if (chunk >= chunks.size()) return nullptr;
+
+    const Chunk& entries = *chunks[chunk];
+    size_t offset = id.index % SERVERSNAPSHOT_CHUNK_SIZE;
+    if (offset >= entries.size()) return nullptr;
+
+    const Entry& entry = entries[offset];
+    return entry.record && entry.generation == id.generation ? &entry : nullptr;
+}
+
+const ServerInfo* ServerSnapshot::Get(ServerId id) const {
+    const Entry* entry = Find(id);
+    return entry ? entry->record.get() : nullptr;
+}
+
+ServerRecordRef ServerSnapshot::GetRef(ServerId id) const {
+    const Entry* entry = Find(id);
+    return entry ? entry->record : ServerRecordRef();
+}
+
+uint64_t ServerSnapshot::GetStamp(ServerId id) const {
+    const Entry* entry = Find(id);
+    return entry ? entry->stamp : 0;
+}
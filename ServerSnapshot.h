@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "ServerQuery.h"
+
+
+#define SERVERSNAPSHOT_CHUNK_SIZE   256
+
+
+struct ServerId;
+
+typedef std::shared_ptr<const ServerInfo> ServerRecordRef;
+
+
+class ServerSnapshot {
+public:
+    struct Entry {
+        ServerRecordRef record;
+        uint32_t generation = 0;
+        uint64_t stamp = 0;
+    };
+
+    typedef std::vector<Entry> Chunk;
+
+    const ServerInfo* Get(ServerId id) const;
+    ServerRecordRef GetRef(ServerId id) const;
+    uint64_t GetStamp(ServerId id) const;
+
+    uint64_t GetVersion() const { return version; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    template <typename Callback>
+    void ForEach(Callback callback) const {
+        for (const auto& chunk : chunks) {
+            for (const Entry& entry : *chunk) {
+                if (entry.record) callback(*entry.record);
+            }
+        }
+    }
+
+private:
+    friend class ServerStore;
+
+    const Entry* Find(ServerId id) const;
+
+    std::vector<std::shared_ptr<const Chunk>> chunks;
+    uint64_t version = 0;
+    size_t count = 0;
+};
+
+typedef std::shared_ptr<const ServerSnapshot> ServerSnapshotRef;
@@ -0,0 +1,171 @@
+#include "ServerSort.h"
+#include "ServerStore.h"
+#include "ThreadPool.h"
+#include "resource.h"
+#include <algorithm>
+
+
+SortKey SortKey::FromServer(const ServerInfo& server) {
+    SortKey key;
+    key.name = PackPrefix(server.name, 0);
+    key.nameTail = PackPrefix(server.name, 8);
+    key.map = PackPrefix(server.map.lower(), 0);
+    key.version = PackPrefix(server.version.lower(), 0);
+    key.address = ServerUtils::PackAddress(server.ip, server.port);
+    key.players = server.players;
+    key.ping = server.ping < 0 ? UINT32_MAX : static_cast<uint32_t>(server.ping);
+    return key;
+}
+
+uint64_t SortKey::PackPrefix(const std::string& text, size_t offset) {
+    uint64_t word = 0;
+    for (size_t i = offset; i < offset + 8; ++i) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : 0;
+        word = (word << 8) | ServerSorter::ToLower(c);
+    }
+    return word;
+}
+
+
+void ServerSorter::Promote(std::vector<SortSpec>& specs, const SortSpec& primary) {
+    specs.erase(std::remove_if(specs.begin(), specs.end(), [&](const SortSpec& spec) {
+        return spec.column == primary.column;
+        }), specs.end());
+
+    specs.insert(specs.begin(), primary);
+    if (specs.size() > SERVERSORT_MAX_KEYS) {
+        specs.resize(SERVERSORT_MAX_KEYS);
+    }
+}
+
+void ServerSorter::SetOrder(const ServerStore& sourceStore, const std::vector<SortSpec>& specs) {
+    store = &sourceStore;
+    active.assign(specs.begin(), specs.begin() + (std::min)(specs.size(), static_cast<size_t>(SERVERSORT_MAX_KEYS)));
+
+    nameDescending = false;
+    for (const SortSpec& spec : active) {
+        if (spec.column == SORT_NAME) nameDescending = !spec.ascending;
+    }
+}
+
+ServerSorter::Entry ServerSorter::MakeEntry(ServerId id) const {
+    Entry entry;
+    entry.index = id.index;
+    entry.generation = id.generation;
+    entry.nameTail = store->GetSortKey(id.index).nameTail;
+    if (nameDescending) entry.nameTail = ~entry.nameTail;
+
+    for (size_t k = 0; k < SERVERSORT_MAX_KEYS; ++k) {
+        entry.keys[k] = k < active.size() ? GetKey(id.index, active[k]) : 0;
+    }
+    return entry;
+}
+
+void ServerSorter::Sort(const ServerStore& sourceStore, const std::vector<SortSpec>& specs, std::vector<ServerId>& rows) {
+    SetOrder(sourceStore, specs);
+
+    entries.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        entries[i] = MakeEntry(rows[i]);
+    }
+
+    SortEntries();
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i] = ServerId(entries[i].index, entries[i].generation);
+    }
+}
+
+uint64_t ServerSorter::GetKey(uint32_t index, const SortSpec& spec) const {
+    const SortKey& sortKey = store->GetSortKey(index);
+    uint64_t key = 0;
+
+    switch (spec.column) {
+    case SORT_NAME:
+        key = sortKey.name;
+        break;
+    case SORT_MAP:
+        key = sortKey.map;
+        break;
+    case SORT_PLAYERS:
+        key = sortKey.players;
+        break;
+    case SORT_PING:
+        key = sortKey.ping;
+        break;
+    case SORT_IP:
+        key = sortKey.address;
+        break;
+    case SORT_VERSION:
+        key = sortKey.version;
+        break;
+    }
+
+    return spec.ascending ? key : ~key;
+}
+
+int ServerSorter::CompareText(const Entry& a, const Entry& b, int column) const {
+    const ServerInfo* first = store->Get(ServerId(a.index, a.generation));
+    const ServerInfo* second = store->Get(ServerId(b.index, b.generation));
+    if (!first || !second) return 0;
+
+    switch (column) {
+    case SORT_NAME:
+        return CompareNoCase(first->name, second->name);
+    case SORT_MAP:
+        return first->map.lower().compare(second->map.lower());
+    case SORT_VERSION:
+        return first->version.lower().compare(second->version.lower());
+    }
+    return 0;
+}
+
+bool ServerSorter::Less(const Entry& a, const Entry& b) const {
+    for (size_t k = 0; k < active.size(); ++k) {
+        if (a.keys[k] != b.keys[k]) return a.keys[k] < b.keys[k];
+
+        int column = active[k].column;
+        if (column != SORT_NAME && column != SORT_MAP && column != SORT_VERSION) continue;
+        if (column == SORT_NAME && a.nameTail != b.nameTail) return a.nameTail < b.nameTail;
+
+        int compareResult = CompareText(a, b, column);
+        if (compareResult != 0) return active[k].ascending ? compareResult < 0 : compareResult > 0;
+    }
+    return a.index < b.index;
+}
+
+void ServerSorter::SortEntries() {
+    auto less = [this](const Entry& a, const Entry& b) { return Less(a, b); };
+    size_t count = entries.size();
+
+    size_t chunkCount = threadPool ? (std::min)(threadPool->GetThreadCount(), static_cast<size_t>(SERVERSORT_MAX_THREADS)) : 1;
+    if (count < SERVERSORT_PARALLEL_THRESHOLD || chunkCount < 2) {
+        std::sort(entries.begin(), entries.end(), less);
+        return;
+    }
+
+    size_t chunk = (count + chunkCount - 1) / chunkCount;
+    threadPool->ParallelFor((count + chunk - 1) / chunk, [this, chunk, count, &less](size_t part) {
+        size_t begin = part * chunk;
+        size_t end = (std::min)(begin + chunk, count);
+        std::sort(entries.begin() + begin, entries.begin() + end, less);
+        });
+
+    for (size_t width = chunk; width < count; width *= 2) {
+        for (size_t begin = 0; begin + width < count; begin += 2 * width) {
+            size_t end = (std::min)(begin + 2 * width, count);
+            std::inplace_merge(entries.begin() + begin, entries.begin() + begin + width, entries.begin() + end, less);
+        }
+    }
+}
+
+int ServerSorter::CompareNoCase(const std::string& a, const std::string& b) {
+    size_t length = (std::min)(a.size(), b.size());
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char first = ToLower(static_cast<unsigned char>(a[i]));
+        unsigned char second = ToLower(static_cast<unsigned char>(b[i]));
+        if (first != second) return first < second ? -1 : 1;
+    }
+    if (a.size() == b.size()) return 0;
+    return a.size() < b.size() ? -1 : 1;
+}
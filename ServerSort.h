@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "StringPool.h"
+
+struct ServerInfo;
+struct ServerId;
+class ServerStore;
+class ThreadPool;
+
+
+#define SERVERSORT_MAX_KEYS             3
+#define SERVERSORT_PARALLEL_THRESHOLD   16384
+#define SERVERSORT_MAX_THREADS          4
+
+
+struct SortKey {
+    uint64_t name = 0;
+    uint64_t nameTail = 0;
+    uint64_t map = 0;
+    uint64_t version = 0;
+    uint64_t address = 0;
+    uint32_t players = 0;
+    uint32_t ping = UINT32_MAX;
+
+    static SortKey FromServer(const ServerInfo& server);
+    static uint64_t PackPrefix(const std::string& text, size_t offset);
+};
+
+
+struct SortSpec {
+    int column = 0;
+    bool ascending = true;
+
+    bool operator==(const SortSpec& other) const { return column == other.column && ascending == other.ascending; }
+};
+
+
+class ServerSorter {
+public:
+    struct Entry {
+        uint64_t keys[SERVERSORT_MAX_KEYS];
+        uint64_t nameTail;
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    void SetThreadPool(ThreadPool* pool) { threadPool = pool; }
+    void Sort(const ServerStore& store, const std::vector<SortSpec>& specs, std::vector<ServerId>& rows);
+
+    void SetOrder(const ServerStore& store, const std::vector<SortSpec>& specs);
+    Entry MakeEntry(ServerId id) const;
+    bool Less(const Entry& a, const Entry& b) const;
+    const std::vector<Entry>& GetEntries() const { return entries; }
+
+    static void Promote(std::vector<SortSpec>& specs, const SortSpec& primary);
+    static unsigned char ToLower(unsigned char c) { return c >= 'A' && c <= 'Z' ? static_cast<unsigned char>(c + 32) : c; }
+
+private:
+    uint64_t GetKey(uint32_t index, const SortSpec& spec) const;
+    int CompareText(const Entry& a, const Entry& b, int column) const;
+    void SortEntries();
+
+    static int CompareNoCase(const std::string& a, const std::string& b);
+
+    const ServerStore* store = nullptr;
+    ThreadPool* threadPool = nullptr;
+    std::vector<SortSpec> active;
+    bool nameDescending = false;
+    std::vector<Entry> entries;
+};
@@ -0,0 +1,351 @@
+#include "ServerStore.h"
+
+
+ServerId ServerStore::Upsert(ServerInfo&& server) {
+    revision++;
+    uint64_t address = ServerUtils::PackAddress(server.ip, server.port);
+
+    ServerId existing = address ? FindPacked(address) : FindId(server.ip, server.port);
+    if (existing.IsValid()) {
+        slots[existing.index].record = std::move(server);
+        IndexSlot(existing.index);
+        return existing;
+    }
+
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+
+    Slot& slot = slots[index];
+    slot.record = std::move(server);
+    slot.live = true;
+
+    LinkSlot(index);
+    if (address) {
+        addressIndex[address] = index;
+    }
+    IndexSlot(index);
+
+    return ServerId(index, slot.generation);
+}
+
+bool ServerStore::Remove(ServerId id) {
+    if (!Get(id)) return false;
+    revision++;
+
+    Slot& slot = slots[id.index];
+    uint64_t address = ServerUtils::PackAddress(slot.record.ip, slot.record.port);
+    if (address) {
+        addressIndex.erase(address);
+    }
+
+    UnlinkSlot(id.index);
+    UnindexSlot(id.index);
+
+    slot.record = ServerInfo();
+    slot.live = false;
+    slot.generation++;
+    freeSlots.push_back(id.index);
+    return true;
+}
+
+void ServerStore::Clear() {
+    revision++;
+    freeSlots.clear();
+    for (size_t i = slots.size(); i-- > 0;) {
+        Slot& slot = slots[i];
+        if (slot.live) {
+            slot.record = ServerInfo();
+            slot.live = false;
+            slot.generation++;
+        }
+        freeSlots.push_back(static_cast<uint32_t>(i));
+    }
+
+    order.clear();
+    addressIndex.clear();
+    searchIndex.Clear();
+    liveRows.Clear();
+    for (RowBitmap& attribute : attributes) {
+        attribute.Clear();
+    }
+
+    changes.clear();
+    changesOverflow = true;
+    dirtyChunks.Assign((slots.size() + SERVERSNAPSHOT_CHUNK_SIZE - 1) / SERVERSNAPSHOT_CHUNK_SIZE, true);
+}
+
+void ServerStore::Update(ServerId id) {
+    if (Get(id)) {
+        IndexSlot(id.index);
+        revision++;
+    }
+}
+
+void ServerStore::Update(const ServerInfo& record) {
+    Update(FindId(record.ip, record.port));
+}
+
+void ServerStore::IndexSlot(uint32_t index) {
+    Slot& slot = slots[index];
+    slot.stamp = ++stampCounter;
+    RecordChange(index);
+    if (!indexed) return;
+
+    const ServerInfo& record = slot.record;
+    searchIndex.Insert(index, record.name, record.map, record.ip);
+    if (facetKeys.size() <= index) {
+        facetKeys.resize(slots.size());
+        sortKeys.resize(slots.size());
+    }
+    facetKeys[index] = FacetKey::FromServer(record);
+    sortKeys[index] = SortKey::FromServer(record);
+
+    liveRows.Set(index);
+    attributes[SERVER_ATTR_PASSWORDED].Set(index, record.isPassworded);
+    attributes[SERVER_ATTR_FULL].Set(index, record.isFull());
+    attributes[SERVER_ATTR_MODDED].Set(index, record.hasMods());
+    attributes[SERVER_ATTR_OFFICIAL].Set(index, record.isOfficial);
+    attributes[SERVER_ATTR_LAN].Set(index, ServerUtils::IsLANAddress(record.ip));
+    attributes[SERVER_ATTR_FAVORITE].Set(index, record.isFavorite);
+    attributes[SERVER_ATTR_PLAYED].Set(index, record.isPlayed);
+    attributes[SERVER_ATTR_FIRST_PERSON].Set(index, record.isFirstPerson);
+    attributes[SERVER_ATTR_THIRD_PERSON].Set(index, !record.isFirstPerson);
+    attributes[SERVER_ATTR_ONLINE].Set(index, record.isOnline());
+}
+
+void ServerStore::UnindexSlot(uint32_t index) {
+    RecordChange(index);
+    if (!indexed) return;
+
+    searchIndex.Remove(index);
+    liveRows.Reset(index);
+    for (RowBitmap& attribute : attributes) {
+        attribute.Reset(index);
+    }
+}
+
+void ServerStore::RecordChange(uint32_t index) {
+    dirtyChunks.Set(index / SERVERSNAPSHOT_CHUNK_SIZE);
+    if (changesOverflow) return;
+    if (changes.size() >= SERVERSTORE_MAX_CHANGES) {
+        changes.clear();
+        changesOverflow = true;
+        return;
+    }
+    changes.push_back(index);
+}
+
+void ServerStore::LinkSlot(uint32_t index) {
+    slots[index].position = static_cast<uint32_t>(order.size());
+    order.push_back(index);
+}
+
+void ServerStore::UnlinkSlot(uint32_t index) {
+    uint32_t position = slots[index].position;
+    uint32_t moved = order.back();
+    order[position] = moved;
+    slots[moved].position = position;
+    order.pop_back();
+}
+
+void ServerStore::Mirror(const ServerSnapshot& snapshot, const std::vector<uint32_t>& changed) {
+    for (uint32_t index : changed) {
+        MirrorSlot(snapshot, index);
+    }
+}
+
+void ServerStore::Mirror(const ServerSnapshot& snapshot) {
+    Clear();
+    size_t count = snapshot.chunks.size() * SERVERSNAPSHOT_CHUNK_SIZE;
+    for (size_t index = 0; index < count; ++index) {
+        MirrorSlot(snapshot, static_cast<uint32_t>(index));
+    }
+}
+
+void ServerStore::MirrorSlot(const ServerSnapshot& snapshot, uint32_t index) {
+    const ServerSnapshot::Entry* entry = nullptr;
+    size_t chunk = index / SERVERSNAPSHOT_CHUNK_SIZE;
+    size_t offset = index % SERVERSNAPSHOT_CHUNK_SIZE;
+    if (chunk < snapshot.chunks.size() && offset < snapshot.chunks[chunk]->size()) {
+        entry = &(*snapshot.chunks[chunk])[offset];
+        if (!entry->record) entry = nullptr;
+    }
+
+    if (!entry && index >= slots.size()) return;
+    while (slots.size() <= index) {
+        slots.emplace_back();
+    }
+
+    Slot& slot = slots[index];
+    revision++;
+    if (slot.live && (!entry || entry->generation != slot.generation)) {
+        addressIndex.erase(ServerUtils::PackAddress(slot.record.ip, slot.record.port));
+        UnlinkSlot(index);
+        UnindexSlot(index);
+        slot.record = ServerInfo();
+        slot.live = false;
+    }
+    if (!entry) return;
+
+    if (!slot.live) {
+        LinkSlot(index);
+        slot.live = true;
+    }
+    slot.record = *entry->record;
+    slot.generation = entry->generation;
+
+    uint64_t address = ServerUtils::PackAddress(slot.record.ip, slot.record.port);
+    if (address) {
+        addressIndex[address] = index;
+    }
+    IndexSlot(index);
+}
+
+bool ServerStore::TakeChanges(uint64_t sinceRevision, std::vector<uint32_t>& changed) {
+    bool complete = !changesOverflow && sinceRevision == changesBase;
+    changed.clear();
+    if (complete) {
+        changed.swap(changes);
+    }
+
+    changes.clear();
+    changesOverflow = false;
+    changesBase = revision;
+    return complete;
+}
+
+ServerSnapshotRef ServerStore::Publish() {
+    ServerSnapshotRef current = GetSnapshot();
+    if (current->version == revision && !dirtyChunks.Any()) return current;
+
+    auto next = std::make_shared<ServerSnapshot>();
+    size_t chunkCount = (slots.size() + SERVERSNAPSHOT_CHUNK_SIZE - 1) / SERVERSNAPSHOT_CHUNK_SIZE;
+    next->chunks.reserve(chunkCount);
+
+    for (size_t c = 0; c < chunkCount; ++c) {
+        const ServerSnapshot::Chunk* previous = c < current->chunks.size() ? current->chunks[c].get() : nullptr;
+        if (previous && !dirtyChunks.Test(c)) {
+            next->chunks.push_back(current->chunks[c]);
+            continue;
+        }
+
+        size_t first = c * SERVERSNAPSHOT_CHUNK_SIZE;
+        size_t last = (std::min)(slots.size(), first + SERVERSNAPSHOT_CHUNK_SIZE);
+        auto chunk = std::make_shared<ServerSnapshot::Chunk>(last - first);
+
+        for (size_t i = 0; i < chunk->size(); ++i) {
+            const Slot& slot = slots[first + i];
+            if (!slot.live) continue;
+
+            ServerSnapshot::Entry& entry = (*chunk)[i];
+            if (previous && i < previous->size() && (*previous)[i].stamp == slot.stamp) {
+                entry = (*previous)[i];
+            }
+            else {
+                entry.record = std::make_shared<const ServerInfo>(slot.record);
+                entry.generation = slot.generation;
+                entry.stamp = slot.stamp;
+            }
+        }
+        next->chunks.push_back(std::move(chunk));
+    }
+
+    next->version = revision;
+    next->count = order.size();
+    dirtyChunks.Clear();
+
+    ServerSnapshotRef published(std::move(next));
+    snapshot.store(published);
+    return published;
+}
+
+ServerSnapshotRef ServerStore::GetSnapshot() const {
+    return snapshot.load();
+}
+
+void ServerStore::Reserve(size_t count) {
+    order.reserve(count);
+    addressIndex.reserve(count);
+}
+
+ServerInfo* ServerStore::Get(ServerId id) {
+    if (id.index >= slots.size()) return nullptr;
+    Slot& slot = slots[id.index];
+    return (slot.live && slot.generation == id.generation) ? &slot.record : nullptr;
+}
+
+const ServerInfo* ServerStore::Get(ServerId id) const {
+    if (id.index >= slots.size()) return nullptr;
+    const Slot& slot = slots[id.index];
+    return (slot.live && slot.generation == id.generation) ? &slot.record : nullptr;
+}
+
+ServerId ServerStore::FindId(const std::string& ip, int port) const {
+    uint64_t address = ServerUtils::PackAddress(ip, port);
+    if (address) {
+        return FindPacked(address);
+    }
+
+    for (uint32_t index : order) {
+        const ServerInfo& record = slots[index].record;
+        if (record.port == port && record.ip == ip) {
+            return ServerId(index, slots[index].generation);
+        }
+    }
+    return ServerId();
+}
+
+ServerId ServerStore::FindPacked(uint64_t address) const {
+    auto it = addressIndex.find(address);
+    if (it == addressIndex.end()) return ServerId();
+    return ServerId(it->second, slots[it->second].generation);
+}
+
+ServerId ServerStore::GetIdAt(size_t position) const {
+    if (position >= order.size()) return ServerId();
+    uint32_t index = order[position];
+    return ServerId(index, slots[index].generation);
+}
+
+ServerId ServerStore::GetSlotId(uint32_t index) const {
+    if (index >= slots.size() || !slots[index].live) return ServerId();
+    return ServerId(index, slots[index].generation);
+}
+
+RowBitmap ServerStore::MatchSearch(const std::string& term) const {
+    if (term.empty()) return liveRows;
+
+    RowBitmap matches(slots.size());
+
+    std::vector<uint32_t> candidates;
+    searchIndex.Search(TextSearch(term), candidates);
+    for (uint32_t index : candidates) {
+        matches.Set(index);
+    }
+    return matches;
+}
+
+bool ServerStore::MatchesSearch(ServerId id, const TextSearch& term) const {
+    return Get(id) && searchIndex.Matches(id.index, term);
+}
+
+size_t ServerStore::GetMemoryUsage() const {
+    size_t total = (slots.size() - order.size()) * sizeof(Slot) +
+        (freeSlots.capacity() + order.capacity()) * sizeof(uint32_t) +
+        addressIndex.bucket_count() * sizeof(void*) +
+        addressIndex.size() * (sizeof(std::pair<const uint64_t, uint32_t>) + 2 * sizeof(void*)) +
+        searchIndex.GetMemoryUsage() + liveRows.GetMemoryUsage() * (SERVER_ATTR_COUNT + 1) +
+        facetKeys.capacity() * sizeof(FacetKey) + sortKeys.capacity() * sizeof(SortKey);
+
+    for (uint32_t index : order) {
+        total += slots[index].record.getMemoryUsage() + sizeof(Slot) - sizeof(ServerInfo);
+    }
+    return total;
+}
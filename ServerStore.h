@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include "ServerId.h"
+#include "ServerQuery.h"
+#include "TrigramIndex.h"
+#include "RowBitmap.h"
+#include "FacetCounts.h"
+#include "ServerSort.h"
+#include "ServerSnapshot.h"
+
+
+#define SERVERSTORE_MAX_CHANGES     4096
+
+#define SERVER_ATTR_PASSWORDED      0
+#define SERVER_ATTR_FULL            1
+#define SERVER_ATTR_MODDED          2
+#define SERVER_ATTR_OFFICIAL        3
+#define SERVER_ATTR_LAN             4
+#define SERVER_ATTR_FAVORITE        5
+#define SERVER_ATTR_PLAYED          6
+#define SERVER_ATTR_FIRST_PERSON    7
+#define SERVER_ATTR_THIRD_PERSON    8
+#define SERVER_ATTR_ONLINE          9
+#define SERVER_ATTR_COUNT           10
+
+
+class ServerStore {
+private:
+    struct Slot {
+        ServerInfo record;
+        uint64_t stamp = 0;
+        uint32_t generation = 1;
+        uint32_t position = 0;
+        bool live = false;
+    };
+
+    template <typename Value, typename SlotContainer>
+    class Iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value* pointer;
+        typedef Value& reference;
+
+        Iterator(SlotContainer* slots, std::vector<uint32_t>::const_iterator position) : slots(slots), position(position) {}
+
+        reference operator*() const { return (*slots)[*position].record; }
+        pointer operator->() const { return &(*slots)[*position].record; }
+        ServerId GetId() const { return ServerId(*position, (*slots)[*position].generation); }
+        Iterator& operator++() { ++position; return *this; }
+        Iterator operator++(int) { Iterator previous = *this; ++position; return previous; }
+        bool operator==(const Iterator& other) const { return position == other.position; }
+        bool operator!=(const Iterator& other) const { return position != other.position; }
+
+    private:
+        SlotContainer* slots;
+        std::vector<uint32_t>::const_iterator position;
+    };
+
+public:
+    typedef Iterator<ServerInfo, std::deque<Slot>> iterator;
+    typedef Iterator<const ServerInfo, const std::deque<Slot>> const_iterator;
+
+    ServerStore() = default;
+    explicit ServerStore(bool indexed) : indexed(indexed) {}
+
+    ServerId Upsert(ServerInfo&& server);
+    bool Remove(ServerId id);
+    void Update(ServerId id);
+    void Update(const ServerInfo& record);
+    void Clear();
+    void Reserve(size_t count);
+
+    ServerInfo* Get(ServerId id);
+    const ServerInfo* Get(ServerId id) const;
+
+    ServerId FindId(const std::string& ip, int port) const;
+    ServerId FindPacked(uint64_t address) const;
+    ServerInfo* Find(const std::string& ip, int port) { return Get(FindId(ip, port)); }
+    const ServerInfo* Find(const std::string& ip, int port) const { return Get(FindId(ip, port)); }
+
+    ServerId GetIdAt(size_t position) const;
+    ServerId GetSlotId(uint32_t index) const;
+
+    RowBitmap MatchSearch(const std::string& term) const;
+    bool MatchesSearch(ServerId id, const TextSearch& term) const;
+
+    size_t size() const { return order.size(); }
+    bool empty() const { return order.empty(); }
+    uint64_t GetRevision() const { return revision; }
+    bool TakeChanges(uint64_t sinceRevision, std::vector<uint32_t>& changed);
+
+    ServerSnapshotRef Publish();
+    ServerSnapshotRef GetSnapshot() const;
+    void Mirror(const ServerSnapshot& snapshot, const std::vector<uint32_t>& changed);
+    void Mirror(const ServerSnapshot& snapshot);
+
+    const RowBitmap& GetLiveRows() const { return liveRows; }
+    const RowBitmap& GetAttribute(int attribute) const { return attributes[attribute]; }
+    const FacetKey& GetFacetKey(uint32_t index) const { return facetKeys[index]; }
+    const SortKey& GetSortKey(uint32_t index) const { return sortKeys[index]; }
+    uint64_t GetStamp(uint32_t index) const { return slots[index].stamp; }
+    size_t GetMemoryUsage() const;
+
+    iterator begin() { return iterator(&slots, order.begin()); }
+    iterator end() { return iterator(&slots, order.end()); }
+    const_iterator begin() const { return const_iterator(&slots, order.begin()); }
+    const_iterator end() const { return const_iterator(&slots, order.end()); }
+
+private:
+    void IndexSlot(uint32_t index);
+    void UnindexSlot(uint32_t index);
+    void RecordChange(uint32_t index);
+    void LinkSlot(uint32_t index);
+    void UnlinkSlot(uint32_t index);
+    void MirrorSlot(const ServerSnapshot& snapshot, uint32_t index);
+
+    std::deque<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> order;
+    std::unordered_map<uint64_t, uint32_t> addressIndex;
+    bool indexed = true;
+    TrigramIndex searchIndex;
+    RowBitmap liveRows;
+    RowBitmap attributes[SERVER_ATTR_COUNT];
+    std::vector<FacetKey> facetKeys;
+    std::vector<SortKey> sortKeys;
+    uint64_t revision = 0;
+    uint64_t stampCounter = 0;
+    std::vector<uint32_t> changes;
+    uint64_t changesBase = 0;
+    bool changesOverflow = false;
+    RowBitmap dirtyChunks;
+    std::atomic<ServerSnapshotRef> snapshot{ std::make_shared<ServerSnapshot>() };
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include "CancellationToken.h"
+
+
+#define SINGLEFLIGHT_FRESH_MS       2000
+
+
+struct SingleFlightStats {
+    uint64_t sent = 0;
+    uint64_t joined = 0;
+    uint64_t cached = 0;
+};
+
+
+template <typename Response>
+class SingleFlight {
+public:
+    explicit SingleFlight(std::chrono::milliseconds freshFor = std::chrono::milliseconds(SINGLEFLIGHT_FRESH_MS)) : freshFor(freshFor) {}
+
+    template <typename Fetch>
+    bool Run(uint64_t key, Response& response, Fetch fetch) {
+        while (true) {
+            std::shared_ptr<Flight> flight;
+            bool leader = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto now = std::chrono::steady_clock::now();
+                auto cached = recent.find(key);
+                if (cached != recent.end() && now - cached->second->completedAt < freshFor) {
+                    response = cached->second->response;
+                    stats.cached++;
+                    return true;
+                }
+
+                auto existing = inFlight.find(key);
+                if (existing != inFlight.end()) {
+                    flight = existing->second;
+                    stats.joined++;
+                }
+                else {
+                    flight = std::make_shared<Flight>();
+                    inFlight.emplace(key, flight);
+                    leader = true;
+                    stats.sent++;
+                }
+            }
+
+            if (leader) {
+                OutcomeRef outcome = Lead(key, *flight, fetch);
+                if (outcome->ok) response = outcome->response;
+                return outcome->ok;
+            }
+
+            CancellationToken* cancel = CancellationToken::Current();
+            CancellationToken::Registration wake(cancel, [this, flight]() {
+                { std::lock_guard<std::mutex> lock(mutex); }
+                flight->finished.notify_all();
+            });
+
+            OutcomeRef outcome;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                flight->finished.wait(lock, [&]() { return flight->outcome || (cancel && cancel->IsCancelled()); });
+                outcome = flight->outcome;
+            }
+            if (!outcome) return false;
+            if (outcome->cancelled && !(cancel && cancel->IsCancelled())) continue;
+            if (outcome->ok) response = outcome->response;
+            return outcome->ok;
+        }
+    }
+
+    SingleFlightStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    struct Outcome {
+        bool ok = false;
+        bool cancelled = false;
+        Response response;
+        std::chrono::steady_clock::time_point completedAt;
+    };
+
+    typedef std::shared_ptr<const Outcome> OutcomeRef;
+
+    struct Flight {
+        std::condition_variable finished;
+        OutcomeRef outcome;
+    };
+
+    template <typename Fetch>
+    OutcomeRef Lead(uint64_t key, Flight& flight, Fetch& fetch) {
+        auto outcome = std::make_shared<Outcome>();
+        try {
+            outcome->ok = fetch(outcome->response);
+        }
+        catch (...) {
+            outcome->ok = false;
+        }
+
+        CancellationToken* cancel = CancellationToken::Current();
+        outcome->cancelled = !outcome->ok && cancel && cancel->IsCancelled();
+        outcome->completedAt = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            inFlight.erase(key);
+            flight.outcome = outcome;
+            Expire(outcome->completedAt);
+            if (outcome->ok) {
+                recent[key] = outcome;
+                expiry.emplace_back(key, outcome->completedAt);
+            }
+        }
+        flight.finished.notify_all();
+        return outcome;
+    }
+
+    void Expire(std::chrono::steady_clock::time_point now) {
+        while (!expiry.empty() && now - expiry.front().second >= freshFor) {
+            auto cached = recent.find(expiry.front().first);
+            if (cached != recent.end() && cached->second->completedAt == expiry.front().second) {
+                recent.erase(cached);
+            }
+            expiry.pop_front();
+        }
+    }
+
+    std::chrono::milliseconds freshFor;
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<Flight>> inFlight;
+    std::unordered_map<uint64_t, OutcomeRef> recent;
+    std::deque<std::pair<uint64_t, std::chrono::steady_clock::time_point>> expiry;
+    SingleFlightStats stats;
+};
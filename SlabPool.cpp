@@ -0,0 +1,66 @@
+#include "SlabPool.h"
+
+
+FramePool& FramePool::Instance() {
+    static FramePool pool;
+    return pool;
+}
+
+int FramePool::GetClass(size_t size) {
+    size_t frameSize = FRAMEPOOL_MIN_FRAME;
+    for (int sizeClass = 0; sizeClass < FRAMEPOOL_CLASS_COUNT; ++sizeClass, frameSize <<= 1) {
+        if (size <= frameSize) return sizeClass;
+    }
+    return -1;
+}
+
+void FramePool::Grow(int sizeClass) {
+    size_t frameSize = size_t(FRAMEPOOL_MIN_FRAME) << sizeClass;
+    std::unique_ptr<unsigned char[]> owned(new unsigned char[frameSize * FRAMEPOOL_SLAB_FRAMES]);
+    unsigned char* slab = owned.get();
+    slabs.push_back(std::move(owned));
+
+    for (size_t i = FRAMEPOOL_SLAB_FRAMES; i-- > 0;) {
+        FreeFrame* frame = reinterpret_cast<FreeFrame*>(slab + i * frameSize);
+        frame->next = freeLists[sizeClass];
+        freeLists[sizeClass] = frame;
+    }
+    stats.slabs++;
+    stats.slabBytes += frameSize * FRAMEPOOL_SLAB_FRAMES;
+}
+
+void* FramePool::Allocate(size_t size) {
+    int sizeClass = GetClass(size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.allocations++;
+        if (sizeClass >= 0) {
+            if (!freeLists[sizeClass]) Grow(sizeClass);
+            FreeFrame* frame = freeLists[sizeClass];
+            freeLists[sizeClass] = frame->next;
+            stats.peak = (std::max)(stats.peak, ++stats.inUse);
+            return frame;
+        }
+        stats.oversized++;
+    }
+    return ::operator new(size);
+}
+
+void FramePool::Deallocate(void* frame, size_t size) {
+    int sizeClass = GetClass(size);
+    if (sizeClass < 0) {
+        ::operator delete(frame);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    FreeFrame* freed = static_cast<FreeFrame*>(frame);
+    freed->next = freeLists[sizeClass];
+    freeLists[sizeClass] = freed;
+    stats.inUse--;
+}
+
+FramePoolStats FramePool::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+
+#define FRAMEPOOL_MIN_FRAME     256
+#define FRAMEPOOL_CLASS_COUNT   5
+#define FRAMEPOOL_SLAB_FRAMES   64
+
+
+struct SlabPoolStats {
+    size_t capacity = 0;
+    size_t inUse = 0;
+    size_t peak = 0;
+    uint64_t acquired = 0;
+    uint64_t exhausted = 0;
+};
+
+
+template <typename T>
+class SlabPool {
+public:
+    SlabPool() = default;
+    explicit SlabPool(size_t capacity) { Reserve(capacity); }
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    bool Reserve(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stats.inUse) return false;
+
+        slots.reset(new Slot[capacity]);
+        freeList = nullptr;
+        for (size_t i = capacity; i-- > 0;) {
+            slots[i].next = freeList;
+            freeList = &slots[i];
+        }
+        stats = SlabPoolStats();
+        stats.capacity = capacity;
+        return true;
+    }
+
+    T* Acquire() {
+        Slot* slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!freeList) {
+                stats.exhausted++;
+                return nullptr;
+            }
+            slot = freeList;
+            freeList = slot->next;
+            stats.acquired++;
+            stats.peak = (std::max)(stats.peak, ++stats.inUse);
+        }
+        return new (slot->storage) T();
+    }
+
+    void Release(T* item) {
+        if (!item) return;
+        item->~T();
+
+        Slot* slot = reinterpret_cast<Slot*>(item);
+        std::lock_guard<std::mutex> lock(mutex);
+        slot->next = freeList;
+        freeList = slot;
+        stats.inUse--;
+    }
+
+    SlabPoolStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    union Slot {
+        Slot() : next(nullptr) {}
+
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    mutable std::mutex mutex;
+    std::unique_ptr<Slot[]> slots;
+    Slot* freeList = nullptr;
+    SlabPoolStats stats;
+};
+
+
+struct FramePoolStats {
+    uint64_t allocations = 0;
+    uint64_t oversized = 0;
+    size_t slabs = 0;
+    size_t slabBytes = 0;
+    size_t inUse = 0;
+    size_t peak = 0;
+};
+
+
+class FramePool {
+public:
+    static FramePool& Instance();
+
+    void* Allocate(size_t size);
+    void Deallocate(void* frame, size_t size);
+    FramePoolStats GetStats() const;
+
+private:
+    struct FreeFrame {
+        FreeFrame* next;
+    };
+
+    static int GetClass(size_t size);
+    void Grow(int sizeClass);
+
+    mutable std::mutex mutex;
+    FreeFrame* freeLists[FRAMEPOOL_CLASS_COUNT] = {};
+    std::vector<std::unique_ptr<unsigned char[]>> slabs;
+    FramePoolStats stats;
+};
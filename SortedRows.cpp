@@ -0,0 +1,178 @@
+#include "SortedRows.h"
+#include "ServerStore.h"
+
+
+void SortedRows::Clear() {
+    nodes.clear();
+    freeNodes.clear();
+    slotNodes.clear();
+    root = SORTEDROWS_NO_NODE;
+}
+
+void SortedRows::Assign(const std::vector<Entry>& sorted) {
+    Clear();
+    nodes.reserve(sorted.size());
+
+    std::vector<int32_t> spine;
+    for (const Entry& entry : sorted) {
+        int32_t node = NewNode(entry);
+        int32_t last = SORTEDROWS_NO_NODE;
+        while (!spine.empty() && nodes[spine.back()].priority < nodes[node].priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        nodes[node].left = last;
+        if (!spine.empty()) {
+            nodes[spine.back()].right = node;
+        }
+        spine.push_back(node);
+    }
+
+    if (!spine.empty()) {
+        PullAll(spine.front());
+        SetRoot(spine.front());
+    }
+}
+
+bool SortedRows::Erase(uint32_t slot, size_t& position) {
+    if (!Contains(slot)) return false;
+
+    int32_t node = slotNodes[slot];
+    position = RankOf(node);
+
+    int32_t before, rest, middle, after;
+    Split(root, position, before, rest);
+    Split(rest, 1, middle, after);
+    SetRoot(Merge(before, after));
+
+    slotNodes[slot] = SORTEDROWS_NO_NODE;
+    freeNodes.push_back(node);
+    return true;
+}
+
+void SortedRows::GetRows(std::vector<ServerId>& rows) const {
+    rows.clear();
+    rows.reserve(size());
+
+    std::vector<int32_t> stack;
+    int32_t node = root;
+    while (node != SORTEDROWS_NO_NODE || !stack.empty()) {
+        while (node != SORTEDROWS_NO_NODE) {
+            stack.push_back(node);
+            node = nodes[node].left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        rows.push_back(ServerId(nodes[node].entry.index, nodes[node].entry.generation));
+        node = nodes[node].right;
+    }
+}
+
+int32_t SortedRows::NewNode(const Entry& entry) {
+    int32_t node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        node = static_cast<int32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& created = nodes[node];
+    created.entry = entry;
+    created.left = SORTEDROWS_NO_NODE;
+    created.right = SORTEDROWS_NO_NODE;
+    created.parent = SORTEDROWS_NO_NODE;
+    created.priority = NextPriority();
+    created.size = 1;
+
+    if (entry.index >= slotNodes.size()) {
+        slotNodes.resize(entry.index + 1, SORTEDROWS_NO_NODE);
+    }
+    slotNodes[entry.index] = node;
+    return node;
+}
+
+void SortedRows::InsertAt(size_t position, const Entry& entry) {
+    int32_t node = NewNode(entry);
+    int32_t before, after;
+    Split(root, position, before, after);
+    SetRoot(Merge(Merge(before, node), after));
+}
+
+size_t SortedRows::RankOf(int32_t node) const {
+    size_t rank = SizeOf(nodes[node].left);
+    while (nodes[node].parent != SORTEDROWS_NO_NODE) {
+        int32_t parent = nodes[node].parent;
+        if (nodes[parent].right == node) {
+            rank += SizeOf(nodes[parent].left) + 1;
+        }
+        node = parent;
+    }
+    return rank;
+}
+
+void SortedRows::Split(int32_t node, size_t count, int32_t& first, int32_t& second) {
+    if (node == SORTEDROWS_NO_NODE) {
+        first = second = SORTEDROWS_NO_NODE;
+        return;
+    }
+
+    Node& current = nodes[node];
+    size_t leftSize = SizeOf(current.left);
+    if (leftSize < count) {
+        Split(current.right, count - leftSize - 1, current.right, second);
+        first = node;
+    }
+    else {
+        Split(current.left, count, first, current.left);
+        second = node;
+    }
+    Pull(node);
+}
+
+int32_t SortedRows::Merge(int32_t first, int32_t second) {
+    if (first == SORTEDROWS_NO_NODE) return second;
+    if (second == SORTEDROWS_NO_NODE) return first;
+
+    if (nodes[first].priority > nodes[second].priority) {
+        int32_t merged = Merge(nodes[first].right, second);
+        nodes[first].right = merged;
+        Pull(first);
+        return first;
+    }
+
+    int32_t merged = Merge(first, nodes[second].left);
+    nodes[second].left = merged;
+    Pull(second);
+    return second;
+}
+
+void SortedRows::Pull(int32_t node) {
+    Node& current = nodes[node];
+    current.size = 1 + SizeOf(current.left) + SizeOf(current.right);
+    if (current.left != SORTEDROWS_NO_NODE) nodes[current.left].parent = node;
+    if (current.right != SORTEDROWS_NO_NODE) nodes[current.right].parent = node;
+}
+
+void SortedRows::PullAll(int32_t node) {
+    if (node == SORTEDROWS_NO_NODE) return;
+    PullAll(nodes[node].left);
+    PullAll(nodes[node].right);
+    Pull(node);
+}
+
+void SortedRows::SetRoot(int32_t node) {
+    root = node;
+    if (root != SORTEDROWS_NO_NODE) {
+        nodes[root].parent = SORTEDROWS_NO_NODE;
+    }
+}
+
+uint32_t SortedRows::NextPriority() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
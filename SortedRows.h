@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "ServerSort.h"
+
+
+#define SORTEDROWS_NO_NODE      -1
+
+
+class SortedRows {
+public:
+    typedef ServerSorter::Entry Entry;
+
+    void Clear();
+    void Assign(const std::vector<Entry>& sorted);
+
+    template <typename Less>
+    size_t Insert(const Entry& entry, Less less) {
+        size_t position = 0;
+        Erase(entry.index, position);
+
+        position = 0;
+        int32_t node = root;
+        while (node != SORTEDROWS_NO_NODE) {
+            if (less(nodes[node].entry, entry)) {
+                position += SizeOf(nodes[node].left) + 1;
+                node = nodes[node].right;
+            }
+            else {
+                node = nodes[node].left;
+            }
+        }
+        InsertAt(position, entry);
+        return position;
+    }
+
+    bool Erase(uint32_t slot, size_t& position);
+    bool Contains(uint32_t slot) const { return slot < slotNodes.size() && slotNodes[slot] != SORTEDROWS_NO_NODE; }
+
+    size_t size() const { return SizeOf(root); }
+    bool empty() const { return root == SORTEDROWS_NO_NODE; }
+    void GetRows(std::vector<ServerId>& rows) const;
+
+private:
+    struct Node {
+        Entry entry;
+        int32_t left;
+        int32_t right;
+        int32_t parent;
+        uint32_t priority;
+        uint32_t size;
+    };
+
+    int32_t NewNode(const Entry& entry);
+    void InsertAt(size_t position, const Entry& entry);
+    size_t RankOf(int32_t node) const;
+    void Split(int32_t node, size_t count, int32_t& first, int32_t& second);
+    int32_t Merge(int32_t first, int32_t second);
+    void Pull(int32_t node);
+    void PullAll(int32_t node);
+    void SetRoot(int32_t node);
+    uint32_t NextPriority();
+
+    uint32_t SizeOf(int32_t node) const { return node == SORTEDROWS_NO_NODE ? 0 : nodes[node].size; }
+
+    std::vector<Node> nodes;
+    std::vector<int32_t> freeNodes;
+    std::vector<int32_t> slotNodes;
+    int32_t root = SORTEDROWS_NO_NODE;
+    uint32_t seed = 0x9E3779B9u;
+};
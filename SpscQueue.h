@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool TryPush(T& value) {
+        size_t write = tail.load(std::memory_order_relaxed);
+        if (write - head.load(std::memory_order_acquire) == Capacity) return false;
+
+        items[write & (Capacity - 1)] = std::move(value);
+        tail.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& value) {
+        size_t read = head.load(std::memory_order_relaxed);
+        if (read == tail.load(std::memory_order_acquire)) return false;
+
+        value = std::move(items[read & (Capacity - 1)]);
+        head.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+private:
+    T items[Capacity];
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
@@ -0,0 +1,105 @@
+#include "StringPool.h"
+#include <mutex>
+#include <cctype>
+
+
+StringPool& StringPool::Instance() {
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::StringPool() {
+    chunks[0].reset(new Entry[STRINGPOOL_CHUNK_SIZE]);
+    chunks[0][0].lowerId = STRINGPOOL_EMPTY_ID;
+    lookup.emplace(std::string_view(chunks[0][0].text), STRINGPOOL_EMPTY_ID);
+    count.store(1, std::memory_order_release);
+}
+
+StringId StringPool::Intern(std::string_view text) {
+    if (text.empty()) return STRINGPOOL_EMPTY_ID;
+
+    {
+        std::shared_lock<std::shared_mutex> lock(poolMutex);
+        auto it = lookup.find(text);
+        if (it != lookup.end()) return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(poolMutex);
+    return InternLocked(text);
+}
+
+StringId StringPool::InternLocked(std::string_view text) {
+    auto it = lookup.find(text);
+    if (it != lookup.end()) return it->second;
+
+    std::string lowered(text);
+    bool hasUpper = false;
+    for (char& c : lowered) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+            hasUpper = true;
+        }
+    }
+
+    StringId lowerId = STRINGPOOL_EMPTY_ID;
+    if (hasUpper) {
+        lowerId = InternLocked(lowered);
+        if (lowerId == STRINGPOOL_EMPTY_ID) return STRINGPOOL_EMPTY_ID;
+    }
+
+    uint32_t id = count.load(std::memory_order_relaxed);
+    uint32_t chunkIndex = id / STRINGPOOL_CHUNK_SIZE;
+    if (chunkIndex >= STRINGPOOL_MAX_CHUNKS) {
+        return STRINGPOOL_EMPTY_ID;
+    }
+    if (!chunks[chunkIndex]) {
+        chunks[chunkIndex].reset(new Entry[STRINGPOOL_CHUNK_SIZE]);
+    }
+
+    Entry& entry = chunks[chunkIndex][id % STRINGPOOL_CHUNK_SIZE];
+    entry.text.assign(text.data(), text.size());
+    entry.lowerId = hasUpper ? lowerId : id;
+    lookup.emplace(std::string_view(entry.text), id);
+    textBytes += entry.text.capacity() + 1;
+    count.store(id + 1, std::memory_order_release);
+
+    return id;
+}
+
+StringId StringPool::Find(std::string_view text) const {
+    if (text.empty()) return STRINGPOOL_EMPTY_ID;
+
+    std::shared_lock<std::shared_mutex> lock(poolMutex);
+    auto it = lookup.find(text);
+    return it != lookup.end() ? it->second : STRINGPOOL_EMPTY_ID;
+}
+
+const StringPool::Entry& StringPool::EntryAt(StringId id) const {
+    if (id >= count.load(std::memory_order_acquire)) {
+        id = STRINGPOOL_EMPTY_ID;
+    }
+    return chunks[id / STRINGPOOL_CHUNK_SIZE][id % STRINGPOOL_CHUNK_SIZE];
+}
+
+const std::string& StringPool::Get(StringId id) const {
+    return EntryAt(id).text;
+}
+
+const std::string& StringPool::GetLower(StringId id) const {
+    return EntryAt(EntryAt(id).lowerId).text;
+}
+
+StringId StringPool::GetLowerId(StringId id) const {
+    return EntryAt(id).lowerId;
+}
+
+size_t StringPool::GetCount() const {
+    return count.load(std::memory_order_acquire);
+}
+
+size_t StringPool::GetMemoryUsage() const {
+    std::shared_lock<std::shared_mutex> lock(poolMutex);
+    size_t chunkCount = (count.load(std::memory_order_relaxed) + STRINGPOOL_CHUNK_SIZE - 1) / STRINGPOOL_CHUNK_SIZE;
+    return textBytes + chunkCount * STRINGPOOL_CHUNK_SIZE * sizeof(Entry) +
+        lookup.size() * (sizeof(std::string_view) + sizeof(StringId) + 2 * sizeof(void*));
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+
+typedef uint32_t StringId;
+
+#define STRINGPOOL_EMPTY_ID     0
+#define STRINGPOOL_CHUNK_SIZE   1024
+#define STRINGPOOL_MAX_CHUNKS   256
+
+
+class StringPool {
+public:
+    static StringPool& Instance();
+
+    StringId Intern(std::string_view text);
+    StringId Find(std::string_view text) const;
+
+    const std::string& Get(StringId id) const;
+    const std::string& GetLower(StringId id) const;
+    StringId GetLowerId(StringId id) const;
+
+    size_t GetCount() const;
+    size_t GetMemoryUsage() const;
+
+private:
+    StringPool();
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    struct Entry {
+        std::string text;
+        StringId lowerId = STRINGPOOL_EMPTY_ID;
+    };
+
+    StringId InternLocked(std::string_view text);
+    const Entry& EntryAt(StringId id) const;
+
+    mutable std::shared_mutex poolMutex;
+    std::unordered_map<std::string_view, StringId> lookup;
+    std::unique_ptr<Entry[]> chunks[STRINGPOOL_MAX_CHUNKS];
+    std::atomic<uint32_t> count{ 0 };
+    size_t textBytes = 0;
+};
+
+
+class InternedString {
+public:
+    InternedString() : stringId(STRINGPOOL_EMPTY_ID) {}
+    InternedString(std::string_view text) : stringId(StringPool::Instance().Intern(text)) {}
+    InternedString(const std::string& text) : stringId(StringPool::Instance().Intern(text)) {}
+    InternedString(const char* text) : stringId(StringPool::Instance().Intern(text ? text : "")) {}
+
+    static InternedString FromId(StringId id) {
+        InternedString result;
+        result.stringId = id;
+        return result;
+    }
+
+    StringId id() const { return stringId; }
+    StringId lowerId() const { return StringPool::Instance().GetLowerId(stringId); }
+
+    const std::string& str() const { return StringPool::Instance().Get(stringId); }
+    const std::string& lower() const { return StringPool::Instance().GetLower(stringId); }
+    const char* c_str() const { return str().c_str(); }
+    operator const std::string& () const { return str(); }
+
+    bool empty() const { return stringId == STRINGPOOL_EMPTY_ID; }
+    void clear() { stringId = STRINGPOOL_EMPTY_ID; }
+
+    bool operator==(const InternedString& other) const { return stringId == other.stringId; }
+    bool operator!=(const InternedString& other) const { return stringId != other.stringId; }
+    bool operator==(const std::string& other) const { return str() == other; }
+    bool operator!=(const std::string& other) const { return str() != other; }
+    bool operator==(const char* other) const { return str() == other; }
+    bool operator!=(const char* other) const { return str() != other; }
+
+private:
+    StringId stringId;
+};
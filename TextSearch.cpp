@@ -0,0 +1,217 @@
+#include "TextSearch.h"
+#include <cstdint>
+
+#define TEXTSEARCH_LONG_TEXT    256
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TEXTSEARCH_USE_X86
+#endif
+
+#if defined(TEXTSEARCH_USE_X86) && (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TEXTSEARCH_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef TEXTSEARCH_USE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TEXTSEARCH_AVX2_TARGET
+#else
+#define TEXTSEARCH_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+
+struct FoldTable {
+    char lower[256];
+
+    FoldTable() {
+        for (int c = 0; c < 256; ++c) {
+            lower[c] = static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+        }
+    }
+};
+
+static const FoldTable foldTable;
+
+static inline char FoldAscii(char c) {
+    return foldTable.lower[static_cast<uint8_t>(c)];
+}
+
+static inline bool EqualsFolded(const char* text, const char* lowerNeedle, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (FoldAscii(text[i]) != lowerNeedle[i]) return false;
+    }
+    return true;
+}
+
+static inline uint32_t LowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+
+static size_t FindScalar(const char* text, size_t length, size_t start, const std::string& needle) {
+    size_t n = needle.size();
+    char first = needle[0];
+    char last = needle[n - 1];
+
+    for (size_t i = start; i + n <= length; ++i) {
+        if (FoldAscii(text[i]) == first && FoldAscii(text[i + n - 1]) == last &&
+            EqualsFolded(text + i + 1, needle.data() + 1, n > 2 ? n - 2 : 0)) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+
+#ifdef TEXTSEARCH_USE_SSE2
+static inline __m128i FoldBlock(__m128i block) {
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(block, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+static inline uint32_t CandidatesSse2(const char* text, size_t n, __m128i first, __m128i last) {
+    __m128i blockFirst = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text)));
+    __m128i blockLast = FoldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + n - 1)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+}
+
+static inline size_t VerifyCandidates(const char* text, size_t base, uint32_t mask, const std::string& needle) {
+    size_t n = needle.size();
+    while (mask) {
+        uint32_t bit = LowestBit(mask);
+        if (n <= 2 || EqualsFolded(text + base + bit + 1, needle.data() + 1, n - 2)) {
+            return base + bit;
+        }
+        mask &= mask - 1;
+    }
+    return std::string::npos;
+}
+
+static size_t FindSse2(const char* text, size_t length, size_t start, const std::string& needle) {
+    size_t n = needle.size();
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[n - 1]);
+
+    size_t i = start;
+    for (; i + n - 1 + 16 <= length; i += 16) {
+        size_t found = VerifyCandidates(text, i, CandidatesSse2(text + i, n, first, last), needle);
+        if (found != std::string::npos) return found;
+    }
+
+    if (i + n > length) return std::string::npos;
+    if (length - start < n - 1 + 16) return FindScalar(text, length, i, needle);
+
+    size_t base = length - (n - 1) - 16;
+    uint32_t mask = CandidatesSse2(text + base, n, first, last) & ~((1u << (i - base)) - 1);
+    return VerifyCandidates(text, base, mask, needle);
+}
+#endif
+
+
+#if defined(TEXTSEARCH_USE_X86) && defined(TEXTSEARCH_USE_SSE2)
+TEXTSEARCH_AVX2_TARGET
+static inline __m256i FoldBlockAvx2(__m256i block) {
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8('A' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), block));
+    return _mm256_or_si256(block, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+TEXTSEARCH_AVX2_TARGET
+static size_t FindAvx2(const char* text, size_t length, size_t start, const std::string& needle) {
+    size_t n = needle.size();
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[n - 1]);
+
+    size_t i = start;
+    for (; i + n - 1 + 32 <= length; i += 32) {
+        __m256i blockFirst = FoldBlockAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i)));
+        __m256i blockLast = FoldBlockAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + n - 1)));
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+
+        size_t found = VerifyCandidates(text, i, mask, needle);
+        if (found != std::string::npos) return found;
+    }
+
+    _mm256_zeroupper();
+    return FindSse2(text, length, i, needle);
+}
+
+static bool CpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+    if (!osSavesYmm) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+
+typedef size_t(*FindKernel)(const char*, size_t, size_t, const std::string&);
+
+#ifdef TEXTSEARCH_USE_SSE2
+static const FindKernel shortKernel = FindSse2;
+#else
+static const FindKernel shortKernel = FindScalar;
+#endif
+
+static FindKernel SelectLongKernel(const char** name) {
+#if defined(TEXTSEARCH_USE_X86) && defined(TEXTSEARCH_USE_SSE2)
+    if (CpuHasAvx2()) {
+        *name = "AVX2";
+        return FindAvx2;
+    }
+#endif
+#ifdef TEXTSEARCH_USE_SSE2
+    *name = "SSE2";
+#endif
+    return shortKernel;
+}
+
+static const char* kernelName = "scalar";
+static const FindKernel longKernel = SelectLongKernel(&kernelName);
+
+
+TextSearch::TextSearch(std::string_view term) : needle(term) {
+    ToLowerAscii(needle);
+}
+
+size_t TextSearch::Find(const char* text, size_t length, size_t start) const {
+    if (needle.empty()) return start <= length ? start : std::string::npos;
+    if (start >= length || length - start < needle.size()) return std::string::npos;
+    if (length - start >= TEXTSEARCH_LONG_TEXT) {
+        return longKernel(text, length, start, needle);
+    }
+    return shortKernel(text, length, start, needle);
+}
+
+void TextSearch::ToLowerAscii(std::string& text) {
+    for (char& c : text) {
+        c = FoldAscii(c);
+    }
+}
+
+const char* TextSearch::GetKernelName() {
+    return kernelName;
+}
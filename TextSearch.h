@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+
+class TextSearch {
+public:
+    explicit TextSearch(std::string_view term);
+
+    bool empty() const { return needle.empty(); }
+    size_t size() const { return needle.size(); }
+    const std::string& GetTerm() const { return needle; }
+
+    size_t Find(const char* text, size_t length, size_t start = 0) const;
+    bool Matches(std::string_view text) const { return Find(text.data(), text.size()) != std::string::npos; }
+
+    static void ToLowerAscii(std::string& text);
+    static const char* GetKernelName();
+
+private:
+    std::string needle;
+};
@@ -0,0 +1,160 @@
+#include "ThreadPool.h"
+#include "Platform.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+
+
+thread_local ThreadPool* ThreadPool::currentPool = nullptr;
+thread_local size_t ThreadPool::currentIndex = 0;
+
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    threads = (std::min)((std::max)(threads, static_cast<size_t>(THREADPOOL_MIN_THREADS)), static_cast<size_t>(THREADPOOL_MAX_THREADS));
+
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        try {
+            workers[i]->thread = std::thread(&ThreadPool::Run, this, i);
+        }
+        catch (...) {
+            OutputDebugStringA("ThreadPool: failed to start worker thread\n");
+            break;
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    Shutdown();
+}
+
+bool ThreadPool::Post(std::function<void()> task) {
+    if (!task) return false;
+    if (stopping.load() && currentPool != this) return false;
+
+    size_t index = currentPool == this ? currentIndex : nextWorker++ % workers.size();
+    Worker& worker = *workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(Task{ std::move(task), std::chrono::steady_clock::now() });
+        pending++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+    return true;
+}
+
+bool ThreadPool::Shutdown() {
+    if (currentPool == this) {
+        OutputDebugStringA("ThreadPool: Shutdown called from one of its own workers, ignoring\n");
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    return true;
+}
+
+void ThreadPool::Run(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    Task task;
+    while (true) {
+        if (TryTake(index, task)) {
+            Execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return pending.load() > 0 || stopping.load(); });
+        if (stopping.load() && pending.load() == 0) break;
+    }
+
+    currentPool = nullptr;
+}
+
+bool ThreadPool::TryTake(size_t index, Task& task) {
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending--;
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending--;
+            stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Execute(Task& task) {
+    auto started = std::chrono::steady_clock::now();
+    uint64_t waitUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(started - task.queuedAt).count());
+    totalWaitUs += waitUs;
+    uint64_t previousMax = maxWaitUs.load();
+    while (waitUs > previousMax && !maxWaitUs.compare_exchange_weak(previousMax, waitUs)) {
+    }
+
+    active++;
+    try {
+        task.function();
+    }
+    catch (const std::exception& e) {
+        OutputDebugStringA(("ThreadPool: task threw: " + std::string(e.what()) + "\n").c_str());
+    }
+    catch (...) {
+        OutputDebugStringA("ThreadPool: task threw an unknown exception\n");
+    }
+    active--;
+
+    task.function = nullptr;
+    totalRunUs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count());
+    completed++;
+}
+
+ThreadPoolStats ThreadPool::GetStats() const {
+    ThreadPoolStats stats;
+    stats.threads = workers.size();
+    stats.queued = pending.load();
+    stats.active = active.load();
+    stats.completed = completed.load();
+    stats.stolen = stolen.load();
+    stats.maxWaitMs = maxWaitUs.load() / 1000.0;
+    if (stats.completed > 0) {
+        stats.averageWaitMs = totalWaitUs.load() / 1000.0 / stats.completed;
+        stats.averageRunMs = totalRunUs.load() / 1000.0 / stats.completed;
+    }
+    return stats;
+}
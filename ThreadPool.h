@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+
+#define THREADPOOL_MIN_THREADS      2
+#define THREADPOOL_MAX_THREADS      16
+
+
+struct ThreadPoolStats {
+    size_t threads = 0;
+    size_t queued = 0;
+    size_t active = 0;
+    uint64_t completed = 0;
+    uint64_t stolen = 0;
+    double averageWaitMs = 0.0;
+    double maxWaitMs = 0.0;
+    double averageRunMs = 0.0;
+};
+
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    bool Post(std::function<void()> task);
+
+    template <typename F>
+    auto Submit(F&& function) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        typedef std::invoke_result_t<std::decay_t<F>> Result;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+        std::future<Result> result = task->get_future();
+        if (!Post([task]() { (*task)(); })) {
+            (*task)();
+        }
+        return result;
+    }
+
+    template <typename F, typename C>
+    bool Submit(F&& function, C&& continuation) {
+        typedef std::invoke_result_t<std::decay_t<F>> Result;
+        return Post([this, function = std::forward<F>(function), continuation = std::forward<C>(continuation)]() mutable {
+            if constexpr (std::is_void_v<Result>) {
+                function();
+                Post(std::move(continuation));
+            }
+            else {
+                auto result = std::make_shared<Result>(function());
+                Post([continuation = std::move(continuation), result]() mutable { continuation(std::move(*result)); });
+            }
+        });
+    }
+
+    template <typename F>
+    void ParallelFor(size_t count, F function) {
+        if (count == 0) return;
+
+        struct State {
+            std::atomic<size_t> next{ 0 };
+            std::atomic<size_t> done{ 0 };
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto state = std::make_shared<State>();
+
+        auto drain = [state, count, &function]() {
+            for (size_t i = state->next++; i < count; i = state->next++) {
+                function(i);
+                if (++state->done == count) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        size_t helpers = (std::min)(count - 1, workers.size());
+        for (size_t i = 0; i < helpers; ++i) {
+            if (!Post(drain)) break;
+        }
+        drain();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&]() { return state->done.load() == count; });
+    }
+
+    bool Shutdown();
+
+    size_t GetThreadCount() const { return workers.size(); }
+    ThreadPoolStats GetStats() const;
+
+private:
+    struct Task {
+        std::function<void()> function;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    void Run(size_t index);
+    bool TryTake(size_t index, Task& task);
+    void Execute(Task& task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending{ 0 };
+    std::atomic<size_t> active{ 0 };
+    std::atomic<size_t> nextWorker{ 0 };
+    std::atomic<bool> stopping{ false };
+
+    std::atomic<uint64_t> completed{ 0 };
+    std::atomic<uint64_t> stolen{ 0 };
+    std::atomic<uint64_t> totalWaitUs{ 0 };
+    std::atomic<uint64_t> maxWaitUs{ 0 };
+    std::atomic<uint64_t> totalRunUs{ 0 };
+
+    static thread_local ThreadPool* currentPool;
+    static thread_local size_t currentIndex;
+};
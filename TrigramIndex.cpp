@@ -0,0 +1,221 @@
+#include "TrigramIndex.h"
+#include <algorithm>
+
+
+void TrigramIndex::CollectTrigrams(std::string_view text, std::vector<Trigram>& trigrams) {
+    trigrams.clear();
+    if (text.size() < 3) return;
+
+    trigrams.reserve(text.size() - 2);
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        trigrams.push_back(MakeTrigram(text.data() + i));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+std::string_view TrigramIndex::GetText(uint32_t row) const {
+    if (row >= documents.size() || documents[row].length == 0) return std::string_view();
+    return std::string_view(pool.data() + documents[row].offset, documents[row].length);
+}
+
+void TrigramIndex::Insert(uint32_t row, const std::string& name, const std::string& map, const std::string& ip) {
+    std::string text;
+    text.reserve(name.size() + map.size() + ip.size() + 2);
+    text += name;
+    text += TRIGRAM_FIELD_SEPARATOR;
+    text += map;
+    text += TRIGRAM_FIELD_SEPARATOR;
+    text += ip;
+    TextSearch::ToLowerAscii(text);
+
+    if (row >= documents.size()) {
+        documents.resize(row + 1);
+    }
+    else {
+        std::string_view previous = GetText(row);
+        if (previous == text) return;
+        if (!previous.empty()) {
+            RemovePostings(row, previous);
+            deadBytes += previous.size() + 1;
+        }
+    }
+
+    AddPostings(row, text);
+    AppendText(row, text);
+
+    if (deadBytes > 64 * 1024 && deadBytes > pool.size() / 2) {
+        CompactPool();
+    }
+}
+
+void TrigramIndex::Remove(uint32_t row) {
+    std::string_view text = GetText(row);
+    if (text.empty()) return;
+
+    RemovePostings(row, text);
+    deadBytes += text.size() + 1;
+    documents[row] = Document();
+}
+
+void TrigramIndex::Clear() {
+    pool.clear();
+    poolEntries.clear();
+    documents.clear();
+    postings.clear();
+    deadBytes = 0;
+}
+
+void TrigramIndex::AppendText(uint32_t row, const std::string& text) {
+    Document& document = documents[row];
+    document.offset = static_cast<uint32_t>(pool.size());
+    document.length = static_cast<uint32_t>(text.size());
+
+    poolEntries.push_back({ document.offset, row });
+    pool.insert(pool.end(), text.begin(), text.end());
+    pool.push_back(TRIGRAM_DOCUMENT_END);
+}
+
+void TrigramIndex::CompactPool() {
+    std::vector<char> compacted;
+    compacted.reserve(pool.size() - deadBytes);
+    poolEntries.clear();
+
+    for (uint32_t row = 0; row < documents.size(); ++row) {
+        Document& document = documents[row];
+        if (document.length == 0) continue;
+
+        uint32_t offset = static_cast<uint32_t>(compacted.size());
+        compacted.insert(compacted.end(), pool.begin() + document.offset, pool.begin() + document.offset + document.length);
+        compacted.push_back(TRIGRAM_DOCUMENT_END);
+
+        document.offset = offset;
+        poolEntries.push_back({ offset, row });
+    }
+
+    pool.swap(compacted);
+    deadBytes = 0;
+}
+
+void TrigramIndex::AddPostings(uint32_t row, std::string_view text) {
+    std::vector<Trigram> trigrams;
+    CollectTrigrams(text, trigrams);
+
+    for (Trigram trigram : trigrams) {
+        std::vector<uint32_t>& rows = postings[trigram];
+        if (rows.empty() || rows.back() < row) {
+            rows.push_back(row);
+        }
+        else {
+            auto it = std::lower_bound(rows.begin(), rows.end(), row);
+            if (it == rows.end() || *it != row) {
+                rows.insert(it, row);
+            }
+        }
+    }
+}
+
+void TrigramIndex::RemovePostings(uint32_t row, std::string_view text) {
+    std::vector<Trigram> trigrams;
+    CollectTrigrams(text, trigrams);
+
+    for (Trigram trigram : trigrams) {
+        auto entry = postings.find(trigram);
+        if (entry == postings.end()) continue;
+
+        std::vector<uint32_t>& rows = entry->second;
+        auto it = std::lower_bound(rows.begin(), rows.end(), row);
+        if (it != rows.end() && *it == row) {
+            rows.erase(it);
+        }
+        if (rows.empty()) {
+            postings.erase(entry);
+        }
+    }
+}
+
+void TrigramIndex::Search(const TextSearch& term, std::vector<uint32_t>& rows) const {
+    rows.clear();
+    if (term.size() < 3) {
+        Scan(term, rows);
+        return;
+    }
+
+    std::vector<Trigram> trigrams;
+    CollectTrigrams(term.GetTerm(), trigrams);
+
+    std::vector<const std::vector<uint32_t>*> lists;
+    lists.reserve(trigrams.size());
+    for (Trigram trigram : trigrams) {
+        auto entry = postings.find(trigram);
+        if (entry == postings.end()) return;
+        lists.push_back(&entry->second);
+    }
+
+    std::sort(lists.begin(), lists.end(),
+        [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) { return a->size() < b->size(); });
+
+    rows = *lists[0];
+    for (size_t i = 1; i < lists.size() && !rows.empty(); ++i) {
+        const std::vector<uint32_t>& list = *lists[i];
+        auto position = list.begin();
+        size_t kept = 0;
+        bool gallop = list.size() > rows.size() * 16;
+        for (uint32_t row : rows) {
+            if (gallop) {
+                position = std::lower_bound(position, list.end(), row);
+            }
+            else {
+                while (position != list.end() && *position < row) ++position;
+            }
+            if (position == list.end()) break;
+            if (*position == row) rows[kept++] = row;
+        }
+        rows.resize(kept);
+    }
+
+    if (term.size() == 3) return;
+
+    size_t verified = 0;
+    for (uint32_t row : rows) {
+        if (term.Matches(GetText(row))) {
+            rows[verified++] = row;
+        }
+    }
+    rows.resize(verified);
+}
+
+void TrigramIndex::Scan(const TextSearch& term, std::vector<uint32_t>& rows) const {
+    rows.clear();
+    if (pool.empty()) return;
+
+    size_t position = 0;
+    auto next = poolEntries.begin();
+    while ((position = term.Find(pool.data(), pool.size(), position)) != std::string::npos) {
+        while (next != poolEntries.end() && next->offset <= position) ++next;
+        auto entry = next - 1;
+
+        const Document& document = documents[entry->row];
+        if (document.length > 0 && document.offset == entry->offset) {
+            rows.push_back(entry->row);
+        }
+
+        position = (next != poolEntries.end()) ? next->offset : pool.size();
+    }
+}
+
+bool TrigramIndex::Matches(uint32_t row, const TextSearch& term) const {
+    std::string_view text = GetText(row);
+    return !text.empty() && term.Matches(text);
+}
+
+size_t TrigramIndex::GetMemoryUsage() const {
+    size_t total = pool.capacity() + poolEntries.capacity() * sizeof(PoolEntry) +
+        documents.capacity() * sizeof(Document);
+
+    total += postings.bucket_count() * sizeof(void*);
+    for (const auto& entry : postings) {
+        total += sizeof(entry) + 2 * sizeof(void*) + entry.second.capacity() * sizeof(uint32_t);
+    }
+    return total;
+}
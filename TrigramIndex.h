@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+#include "TextSearch.h"
+
+
+#define TRIGRAM_FIELD_SEPARATOR     '\x1f'
+#define TRIGRAM_DOCUMENT_END        '\0'
+
+
+class TrigramIndex {
+public:
+    void Insert(uint32_t row, const std::string& name, const std::string& map, const std::string& ip);
+    void Remove(uint32_t row);
+    void Clear();
+
+    void Search(const TextSearch& term, std::vector<uint32_t>& rows) const;
+    void Scan(const TextSearch& term, std::vector<uint32_t>& rows) const;
+    bool Matches(uint32_t row, const TextSearch& term) const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    typedef uint32_t Trigram;
+
+    struct Document {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    struct PoolEntry {
+        uint32_t offset;
+        uint32_t row;
+    };
+
+    static Trigram MakeTrigram(const char* text) {
+        return (static_cast<uint8_t>(text[0]) << 16) | (static_cast<uint8_t>(text[1]) << 8) | static_cast<uint8_t>(text[2]);
+    }
+
+    static void CollectTrigrams(std::string_view text, std::vector<Trigram>& trigrams);
+
+    std::string_view GetText(uint32_t row) const;
+    void AppendText(uint32_t row, const std::string& text);
+    void CompactPool();
+
+    void AddPostings(uint32_t row, std::string_view text);
+    void RemovePostings(uint32_t row, std::string_view text);
+
+    std::vector<char> pool;
+    std::vector<PoolEntry> poolEntries;
+    std::vector<Document> documents;
+    size_t deadBytes = 0;
+
+    std::unordered_map<Trigram, std::vector<uint32_t>> postings;
+};
@@ -0,0 +1,47 @@
+#include "FilterQuery.h"
+#include <cstdio>
+#include <string>
+
+
+static ServerInfo MakeServer(const char* map, const char* version) {
+    ServerInfo server;
+    server.name = "Filter Test Server";
+    server.map = map;
+    server.version = version;
+    server.players = 10;
+    server.maxPlayers = 60;
+    server.ping = 40;
+    return server;
+}
+
+static bool Expect(const FilterQuery& query, const ServerInfo& server, bool expected, const char* text) {
+    if (query.Evaluate(server) == expected) return true;
+    printf("FAIL: \"%s\" on map %s, version %s: expected %s\n",
+        text, server.map.c_str(), server.version.c_str(), expected ? "match" : "no match");
+    return false;
+}
+
+static bool VerifyParsedBeforeInterned() {
+    FilterQuery map;
+    FilterQuery version;
+    FilterQuery excluded;
+    if (!map.Parse("map:NeverSeenIsland") || !version.Parse("version:9.99.123456") || !excluded.Parse("map!=NeverSeenIsland")) {
+        printf("FAIL: parse error %s\n", map.GetError().c_str());
+        return false;
+    }
+
+    ServerInfo matching = MakeServer("NeverSeenIsland", "9.99.123456");
+    ServerInfo other = MakeServer("chernarusplus", "1.27.159674");
+    return Expect(map, matching, true, "map:NeverSeenIsland") &&
+        Expect(map, other, false, "map:NeverSeenIsland") &&
+        Expect(version, matching, true, "version:9.99.123456") &&
+        Expect(excluded, matching, false, "map!=NeverSeenIsland") &&
+        Expect(excluded, other, true, "map!=NeverSeenIsland");
+}
+
+
+int main() {
+    if (!VerifyParsedBeforeInterned()) return 1;
+    printf("FilterQuery: map and version terms match servers interned after parsing\n");
+    return 0;
+}
@@ -0,0 +1,303 @@
+#include "QueryEngine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+#define SIM_SERVERS     200
+#define SIM_FLOWS       2000
+#define SIM_SPLIT_RULES 120
+#define SIM_SPLIT_SIZE  500
+
+
+class LoopbackServers {
+public:
+    explicit LoopbackServers(int count) {
+        for (int i = 0; i < count; ++i) {
+            SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            bind(s, (sockaddr*)&address, sizeof(address));
+            getsockname(s, (sockaddr*)&address, &length);
+            sockets.push_back(s);
+            ports.push_back(ntohs(address.sin_port));
+        }
+        thread = std::thread(&LoopbackServers::Run, this);
+    }
+
+    ~LoopbackServers() {
+        stopping = true;
+        thread.join();
+        for (SOCKET s : sockets) closesocket(s);
+    }
+
+    int GetPort(int index) const { return ports[index]; }
+    static bool IsSilent(int index) { return index % 10 == 9; }
+    static bool IsSplit(int index) { return index % 10 == 8; }
+
+private:
+    void Run() {
+        uint8_t packet[1500];
+        while (!stopping) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            SOCKET highest = 0;
+            for (SOCKET s : sockets) {
+                FD_SET(s, &readable);
+                highest = (std::max)(highest, s);
+            }
+
+            timeval timeout{ 0, 20000 };
+            if (select(static_cast<int>(highest + 1), &readable, nullptr, nullptr, &timeout) <= 0) continue;
+
+            for (size_t i = 0; i < sockets.size(); ++i) {
+                if (!FD_ISSET(sockets[i], &readable)) continue;
+
+                sockaddr_in from;
+                socklen_t fromLen = sizeof(from);
+                int bytes = recvfrom(sockets[i], (char*)packet, sizeof(packet), 0, (sockaddr*)&from, &fromLen);
+                if (bytes < 5 || IsSilent(static_cast<int>(i))) continue;
+
+                std::vector<uint8_t> reply;
+                if (!BuildReply(static_cast<int>(i), packet, bytes, reply)) continue;
+                if (reply.size() > SIM_SPLIT_SIZE) {
+                    SendSplit(sockets[i], static_cast<uint32_t>(i + 1), reply, from, fromLen);
+                    continue;
+                }
+                sendto(sockets[i], (const char*)reply.data(), static_cast<int>(reply.size()), 0, (sockaddr*)&from, fromLen);
+            }
+        }
+    }
+
+    static void SendSplit(SOCKET s, uint32_t id, const std::vector<uint8_t>& reply, const sockaddr_in& to, socklen_t toLen) {
+        uint8_t total = static_cast<uint8_t>((reply.size() + SIM_SPLIT_SIZE - 1) / SIM_SPLIT_SIZE);
+        for (int number = total - 1; number >= 0; --number) {
+            std::vector<uint8_t> part = { 0xFE, 0xFF, 0xFF, 0xFF,
+                static_cast<uint8_t>(id), static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id >> 16), static_cast<uint8_t>(id >> 24),
+                total, static_cast<uint8_t>(number), SIM_SPLIT_SIZE & 0xFF, SIM_SPLIT_SIZE >> 8 };
+            size_t offset = static_cast<size_t>(number) * SIM_SPLIT_SIZE;
+            part.insert(part.end(), reply.begin() + offset, reply.begin() + (std::min)(reply.size(), offset + SIM_SPLIT_SIZE));
+            sendto(s, (const char*)part.data(), static_cast<int>(part.size()), 0, (sockaddr*)&to, toLen);
+        }
+    }
+
+    static void AppendString(std::vector<uint8_t>& reply, const std::string& text) {
+        reply.insert(reply.end(), text.begin(), text.end());
+        reply.push_back(0);
+    }
+
+    static bool BuildReply(int index, const uint8_t* packet, int bytes, std::vector<uint8_t>& reply) {
+        static const uint8_t noChallenge[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+        uint8_t type = packet[4];
+        bool challenged = type == A2S_INFO ? bytes == 29 : bytes >= 9 && memcmp(packet + 5, noChallenge, 4) != 0;
+
+        reply.assign(4, 0xFF);
+        if (!challenged) {
+            reply.insert(reply.end(), { 0x41, 1, 2, 3, static_cast<uint8_t>(index) });
+            return true;
+        }
+
+        if (type == A2S_INFO) {
+            reply.insert(reply.end(), { 0x49, 17 });
+            AppendString(reply, "Loopback Server " + std::to_string(index));
+            AppendString(reply, "chernarusplus");
+            AppendString(reply, "dayz");
+            AppendString(reply, "DayZ");
+            reply.insert(reply.end(), { 0, 0, 10, 60, 0, 'd', 'w', 0, 1 });
+            AppendString(reply, "1.27");
+            return true;
+        }
+        if (type == A2S_RULES) {
+            int count = IsSplit(index) ? SIM_SPLIT_RULES : 1;
+            reply.insert(reply.end(), { 0x45, static_cast<uint8_t>(count), 0 });
+            AppendString(reply, "modIds");
+            AppendString(reply, "1559212036;1564026768");
+            for (int rule = 1; rule < count; ++rule) {
+                AppendString(reply, "rule" + std::to_string(rule));
+                AppendString(reply, "value " + std::to_string(rule));
+            }
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<SOCKET> sockets;
+    std::vector<int> ports;
+    std::thread thread;
+    std::atomic<bool> stopping{ false };
+};
+
+
+struct FlowCounts {
+    std::atomic<int> done{ 0 };
+    std::atomic<int> info{ 0 };
+    std::atomic<int> rules{ 0 };
+    std::atomic<int> failed{ 0 };
+};
+
+static bool IsComplete(const A2SRulesResponse& rules) {
+    if (rules.rules.empty() || rules.rules.size() != rules.ruleCount) return false;
+    return rules.ruleCount == 1 || rules.rules.back().value == "value " + std::to_string(rules.ruleCount - 1);
+}
+
+static QueryTask<> RunFlow(QueryEngine& engine, int port, FlowCounts& counts) {
+    QueryResult<A2SInfoResponse> info = co_await engine.QueryInfo("127.0.0.1", port);
+    if (info.ok) {
+        counts.info++;
+        QueryResult<A2SRulesResponse> rules = co_await engine.QueryRules("127.0.0.1", port);
+        if (rules.ok && IsComplete(rules.response)) counts.rules++;
+    }
+    else {
+        counts.failed++;
+    }
+    counts.done++;
+}
+
+static QueryTask<int> OffloadInner(QueryEngine& engine, ThreadPool& pool) {
+    int value = co_await engine.Offload(pool, []() { return 41; });
+    co_return value + 1;
+}
+
+static QueryTask<> OffloadOuter(QueryEngine& engine, ThreadPool& pool, std::atomic<int>& result) {
+    result = co_await OffloadInner(engine, pool);
+}
+
+static QueryTask<> RunTwoHops(QueryEngine& engine, int live, int silent, std::atomic<int>& stage) {
+    QueryResult<A2SInfoResponse> first = co_await engine.QueryInfo("127.0.0.1", live);
+    stage = first.ok ? 1 : -1;
+    QueryResult<A2SInfoResponse> second = co_await engine.QueryInfo("127.0.0.1", silent);
+    stage = second.ok ? -1 : 2;
+}
+
+static bool WaitFor(const std::atomic<int>& value, int expected, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (value.load() != expected && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return value.load() == expected;
+}
+
+
+static bool VerifyFlows(LoopbackServers& servers) {
+    QueryEngine engine;
+    ThreadPool pool(2);
+    if (!engine.Start()) {
+        printf("FAIL: query engine did not start\n");
+        return false;
+    }
+
+    std::atomic<int> offloaded{ 0 };
+    OffloadOuter(engine, pool, offloaded).Detach();
+
+    FlowCounts counts;
+    for (int flow = 0; flow < SIM_FLOWS; ++flow) {
+        RunFlow(engine, servers.GetPort(flow % SIM_SERVERS), counts).Detach();
+    }
+
+    if (!WaitFor(counts.done, SIM_FLOWS, 15000)) {
+        printf("FAIL: %d of %d flows finished\n", counts.done.load(), SIM_FLOWS);
+        return false;
+    }
+
+    QueryEngineStats stats = engine.GetStats();
+    printf("%s\n", stats.Format().c_str());
+
+    int answering = SIM_FLOWS / 10 * 9;
+    if (counts.info != answering || counts.rules != answering || counts.failed != SIM_FLOWS - answering) {
+        printf("FAIL: info %d, rules %d, failed %d\n", counts.info.load(), counts.rules.load(), counts.failed.load());
+        return false;
+    }
+    if (stats.joined == 0 || stats.requests.inUse != 0 || stats.datagrams.inUse != 1) {
+        printf("FAIL: joined %d, requests in use %d, datagrams in use %d\n",
+            static_cast<int>(stats.joined), static_cast<int>(stats.requests.inUse), static_cast<int>(stats.datagrams.inUse));
+        return false;
+    }
+    if (!WaitFor(offloaded, 42, 1000)) {
+        printf("FAIL: nested offload returned %d\n", offloaded.load());
+        return false;
+    }
+    return true;
+}
+
+static bool VerifyStopResumesPending(LoopbackServers& servers) {
+    QueryEngine engine;
+    if (!engine.Start()) return false;
+
+    FlowCounts counts;
+    for (int flow = 0; flow < 50; ++flow) {
+        RunFlow(engine, servers.GetPort(9 + flow % 10 * 10), counts).Detach();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto begin = std::chrono::steady_clock::now();
+    engine.Stop();
+    double stopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    if (counts.done != 50 || counts.failed != 50) {
+        printf("FAIL: stop resumed %d of 50 pending flows\n", counts.done.load());
+        return false;
+    }
+
+    RunFlow(engine, servers.GetPort(0), counts).Detach();
+    if (counts.done != 51 || counts.failed != 51) {
+        printf("FAIL: a flow started after stop did not fail immediately\n");
+        return false;
+    }
+    printf("stop resumed 50 pending flows in %.1f ms\n", stopMs);
+    return true;
+}
+
+static bool VerifyCancellation(LoopbackServers& servers) {
+    QueryEngine engine;
+    if (!engine.Start()) return false;
+
+    CancellationToken token;
+    std::atomic<int> stage{ 0 };
+    {
+        CancellationToken::Scope scope(&token);
+        RunTwoHops(engine, servers.GetPort(0), servers.GetPort(9), stage).Detach();
+    }
+    if (!WaitFor(stage, 1, 5000)) {
+        printf("FAIL: first hop did not complete\n");
+        return false;
+    }
+
+    FlowCounts joiner;
+    RunFlow(engine, servers.GetPort(9), joiner).Detach();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    token.Cancel();
+    engine.Wake();
+    if (!WaitFor(stage, 2, 500)) {
+        printf("FAIL: second hop ignored cancellation\n");
+        return false;
+    }
+    if (joiner.done != 0 || engine.GetStats().requests.inUse != 1) {
+        printf("FAIL: cancelling the leader also ended the joined flow\n");
+        return false;
+    }
+
+    engine.Stop();
+    return joiner.done == 1;
+}
+
+
+int main() {
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+    LoopbackServers servers(SIM_SERVERS);
+    bool passed = VerifyFlows(servers) && VerifyStopResumesPending(servers) && VerifyCancellation(servers);
+
+    WSACleanup();
+    if (!passed) return 1;
+    printf("QueryEngine: flows, split replies, stop and cancellation behave as expected\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "ServerListViewModel.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+static bool ReplayMatches(const std::vector<ListRow>& before, const std::vector<ListChange>& changes, const std::vector<ListRow>& target) {
+    std::vector<ServerId> rows;
+    for (const ListRow& row : before) rows.push_back(row.id);
+
+    for (const ListChange& change : changes) {
+        switch (change.type) {
+        case LIST_CHANGE_REMOVE:
+            if (change.position >= rows.size() || rows[change.position] != change.id) return false;
+            rows.erase(rows.begin() + change.position);
+            break;
+        case LIST_CHANGE_INSERT:
+            if (change.position > rows.size()) return false;
+            rows.insert(rows.begin() + change.position, change.id);
+            break;
+        case LIST_CHANGE_UPDATE:
+            if (change.position >= rows.size() || rows[change.position] != change.id) return false;
+            break;
+        }
+    }
+
+    if (rows.size() != target.size()) return false;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i] != target[i].id) return false;
+    }
+    return true;
+}
+
+
+static bool VerifyRandomDiffs(int rounds) {
+    std::mt19937 rng(5);
+    ServerListViewModel model;
+    std::vector<ListRow> current;
+    std::vector<ListChange> changes;
+    std::vector<uint64_t> stamps(64, 1);
+
+    for (int round = 0; round < rounds; ++round) {
+        std::vector<uint32_t> slots;
+        for (uint32_t slot = 0; slot < 60; ++slot) {
+            if (rng() % 3) slots.push_back(slot);
+        }
+        std::shuffle(slots.begin(), slots.end(), rng);
+        if (rng() % 2) std::sort(slots.begin(), slots.end());
+
+        std::vector<ListRow> next;
+        for (uint32_t slot : slots) {
+            if (rng() % 10 == 0) stamps[slot]++;
+            ListRow row;
+            row.id = ServerId(slot, 1 + (rng() % 20 == 0));
+            row.stamp = stamps[slot];
+            next.push_back(row);
+        }
+
+        model.Diff(next, changes);
+        if (!ReplayMatches(current, changes, next)) {
+            printf("FAIL: round %d: replaying %zu changes does not reproduce the target order\n", round, changes.size());
+            return false;
+        }
+        for (size_t i = 0; i < next.size(); ++i) {
+            if (model.GetId(i) != next[i].id || model.Find(next[i].id) != i) {
+                printf("FAIL: round %d: model row %zu disagrees with the target\n", round, i);
+                return false;
+            }
+        }
+        current = next;
+    }
+    return true;
+}
+
+
+static bool VerifyReverse(size_t count) {
+    ServerListViewModel model;
+    std::vector<ListChange> changes;
+    std::vector<ListRow> rows(count);
+    for (size_t i = 0; i < count; ++i) rows[i].id = ServerId(static_cast<uint32_t>(i), 1);
+
+    model.Diff(rows, changes);
+    std::vector<ListRow> reversed(rows.rbegin(), rows.rend());
+    model.Diff(reversed, changes);
+
+    if (!ReplayMatches(rows, changes, reversed)) {
+        printf("FAIL: reversing %zu rows does not reproduce the target order\n", count);
+        return false;
+    }
+    if (model.GetLastStats().moved != count - 1) {
+        printf("FAIL: reversing %zu rows moved %zu, expected %zu\n", count, model.GetLastStats().moved, count - 1);
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    if (!VerifyRandomDiffs(3000)) return 1;
+    if (!VerifyReverse(2000)) return 1;
+    printf("ServerListViewModel: random diffs and reversal reproduce the target order\n");
+    return 0;
+}
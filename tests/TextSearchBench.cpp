@@ -0,0 +1,133 @@
+#include "TextSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+
+struct SearchFields {
+    std::string name;
+    std::string map;
+    std::string ip;
+};
+
+static const char* nameWords[] = {
+    "Official", "DayZ", "DE", "US", "Chernarus", "Namalsk", "Livonia", "PvP", "PvE", "Hardcore",
+    "Vanilla", "Plus", "Modded", "Trader", "Raid", "Weekend", "Survival", "Community", "1PP", "3PP",
+    "Deer", "Isle", "Expansion", "Zombies", "Loot", "x10", "Base", "Building", "NoKOS", "RP"
+};
+
+static const char* mapNames[] = { "chernarusplus", "enoch", "namalsk", "deerisle", "takistanplus", "banov" };
+
+
+static std::vector<SearchFields> BuildServers(size_t count) {
+    std::mt19937 rng(7);
+    std::vector<SearchFields> servers(count);
+    for (size_t i = 0; i < count; ++i) {
+        SearchFields& server = servers[i];
+        int words = 3 + static_cast<int>(rng() % 6);
+        for (int w = 0; w < words; ++w) {
+            if (w) server.name += " | ";
+            server.name += nameWords[rng() % (sizeof(nameWords) / sizeof(nameWords[0]))];
+        }
+        server.name += " #" + std::to_string(i);
+        server.map = mapNames[rng() % (sizeof(mapNames) / sizeof(mapNames[0]))];
+        server.ip = std::to_string(rng() % 223 + 1) + "." + std::to_string(rng() % 256) + "." +
+            std::to_string(rng() % 256) + "." + std::to_string(rng() % 256);
+    }
+    return servers;
+}
+
+static bool ContainsLowered(std::string text, const std::string& term) {
+    std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+    return text.find(term) != std::string::npos;
+}
+
+static size_t CountTransformFind(const std::vector<SearchFields>& servers, const std::string& term) {
+    size_t hits = 0;
+    for (const SearchFields& server : servers) {
+        if (ContainsLowered(server.name, term) || ContainsLowered(server.map, term) || ContainsLowered(server.ip, term)) {
+            hits++;
+        }
+    }
+    return hits;
+}
+
+static size_t CountKernel(const std::vector<SearchFields>& servers, const TextSearch& search) {
+    size_t hits = 0;
+    for (const SearchFields& server : servers) {
+        if (search.Matches(server.name) || search.Matches(server.map) || search.Matches(server.ip)) {
+            hits++;
+        }
+    }
+    return hits;
+}
+
+static bool VerifyKernel(int cases) {
+    static const char alphabet[] = "aAbBzZ[@`{ \x80\xc3";
+    const size_t alphabetSize = sizeof(alphabet) - 1;
+
+    std::mt19937 rng(3);
+    for (int i = 0; i < cases; ++i) {
+        std::string text(rng() % 300, 'a');
+        for (char& c : text) c = alphabet[rng() % alphabetSize];
+        std::string term(1 + rng() % 5, 'a');
+        for (char& c : term) c = alphabet[rng() % alphabetSize];
+        size_t start = text.empty() ? 0 : rng() % text.size();
+
+        TextSearch search(term);
+        std::string lowered = text;
+        std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+        size_t expected = lowered.find(search.GetTerm(), start);
+        size_t found = search.Find(text.data(), text.size(), start);
+        if (found != expected) {
+            printf("FAIL: term \"%s\" from %zu: kernel %zu, transform+find %zu\n", term.c_str(), start, found, expected);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    int rounds = quick ? 2 : 20;
+
+    if (!VerifyKernel(quick ? 20000 : 300000)) return 1;
+
+    std::vector<SearchFields> servers = BuildServers(20000);
+    size_t bytes = 0;
+    for (const SearchFields& server : servers) {
+        bytes += server.name.size() + server.map.size() + server.ip.size();
+    }
+
+    printf("%d servers, %zu KB of search text, kernel %s\n",
+        static_cast<int>(servers.size()), bytes / 1024, TextSearch::GetKernelName());
+
+    int failures = 0;
+    for (const char* query : { "zq", "p", "pv", "pvp", "namalsk", "xyzzy", "192.1" }) {
+        TextSearch search(query);
+        size_t oldHits = 0;
+        size_t newHits = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) oldHits = CountTransformFind(servers, search.GetTerm());
+        std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) newHits = CountKernel(servers, search);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        double oldUs = std::chrono::duration<double, std::micro>(middle - start).count() / rounds;
+        double newUs = std::chrono::duration<double, std::micro>(end - middle).count() / rounds;
+        printf("%-8s hits %5zu  transform+find %8.0f us  kernel %7.0f us  %5.1fx\n",
+            query, newHits, oldUs, newUs, newUs > 0 ? oldUs / newUs : 0.0);
+
+        if (oldHits != newHits) {
+            printf("FAIL: \"%s\" matched %zu rows with transform+find, %zu with the kernel\n", query, oldHits, newHits);
+            failures++;
+        }
+    }
+    return failures ? 1 : 0;
+}